@@ -0,0 +1,220 @@
+#include <string.h>
+#include <cmath>
+
+#include "allele_stats.h"
+#include "defs.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+
+//Pending counters move by at most 1 per update.
+const uint_fast32_t kMaxPending = 32767;
+
+uint64_t load_le(const char* p, unsigned int width)
+{
+    uint64_t v = 0;
+    for(unsigned int b = 0; b < width; b++)
+    {
+        v |= static_cast<uint64_t>(static_cast<unsigned char>(p[b])) << (8 * b);
+    }
+    return v;
+}
+
+double binary_entropy(double p)
+{
+    if(p <= 0.0 || p >= 1.0)
+    {
+        return 0.0;
+    }
+    return -(p * std::log2(p) + (1.0 - p) * std::log2(1.0 - p));
+}
+
+} //namespace
+
+AlleleStats::AlleleStats(uint_fast32_t loci, unsigned int typed_width) :
+    m_loci(loci),
+    m_width(typed_width == fn_INT || typed_width == fn_LONG ? typed_width : 0),
+    m_individuals(0),
+    m_counts(static_cast<size_t>(loci) * 8, 0),
+    m_pending(static_cast<size_t>(loci) * 8, 0),
+    m_pending_ops(0),
+    m_scratch(loci, 0)
+{
+    if(m_width != 0)
+    {
+        m_sum.assign(loci / m_width, Uint128());
+        if(m_width == fn_INT)
+        {
+            m_sumsq.assign(loci / m_width, Uint128());
+        } else
+        {
+            m_sumsq_long.assign(loci / m_width, 0.0L);
+        }
+    }
+}
+
+void AlleleStats::flush()
+{
+    for(size_t i = 0; i < m_counts.size(); i++)
+    {
+        m_counts[i] = static_cast<uint32_t>(static_cast<int64_t>(m_counts[i]) + m_pending[i]);
+        m_pending[i] = 0;
+    }
+    m_pending_ops = 0;
+}
+
+void AlleleStats::update(const CharDna& genome, int sign)
+{
+    if(m_pending_ops == kMaxPending)
+    {
+        flush();
+    }
+    m_pending_ops++;
+    if(sign > 0)
+    {
+        m_individuals++;
+    } else
+    {
+        m_individuals--;
+    }
+    const char* data = genome.all_data();
+    if(genome.len() < m_loci)
+    {
+        if(genome.len() > 0)
+        {
+            memcpy(m_scratch.data(), data, genome.len());
+        }
+        memset(m_scratch.data() + genome.len(), 0, m_loci - genome.len());
+        data = m_scratch.data();
+    }
+    uint_fast32_t l = 0;
+#if defined(__SSE2__)
+    const __m128i ones = _mm_set1_epi8(1);
+    const __m128i zero = _mm_setzero_si128();
+    for(; l + 16 <= m_loci; l += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + l));
+        for(unsigned int k = 0; k < 8; k++)
+        {
+            //0 or 1 per byte, widened to the 16-bit counters.
+            __m128i bits = _mm_and_si128(_mm_srli_epi16(v, static_cast<int>(k)), ones);
+            __m128i lo = _mm_unpacklo_epi8(bits, zero);
+            __m128i hi = _mm_unpackhi_epi8(bits, zero);
+            __m128i* p = reinterpret_cast<__m128i*>(m_pending.data() + k * m_loci + l);
+            __m128i c0 = _mm_loadu_si128(p);
+            __m128i c1 = _mm_loadu_si128(p + 1);
+            if(sign > 0)
+            {
+                c0 = _mm_add_epi16(c0, lo);
+                c1 = _mm_add_epi16(c1, hi);
+            } else
+            {
+                c0 = _mm_sub_epi16(c0, lo);
+                c1 = _mm_sub_epi16(c1, hi);
+            }
+            _mm_storeu_si128(p, c0);
+            _mm_storeu_si128(p + 1, c1);
+        }
+    }
+#endif
+    for(; l < m_loci; l++)
+    {
+        unsigned char b = static_cast<unsigned char>(data[l]);
+        for(unsigned int k = 0; k < 8; k++)
+        {
+            m_pending[k * m_loci + l] += sign * ((b >> k) & 1);
+        }
+    }
+    for(size_t g = 0; g < m_sum.size(); g++)
+    {
+        uint64_t v = load_le(data + g * m_width, m_width);
+        if(sign > 0)
+        {
+            m_sum[g] += v;
+        } else
+        {
+            m_sum[g] -= v;
+        }
+        if(m_width == fn_INT)
+        {
+            Uint128 sq = Uint128::mul(v, v);
+            m_sumsq[g] = sign > 0 ? m_sumsq[g] + sq : m_sumsq[g] - sq;
+        } else
+        {
+            long double x = static_cast<long double>(v);
+            m_sumsq_long[g] += sign * x * x;
+        }
+    }
+}
+
+void AlleleStats::insert(const std::vector<const CharDna*>& genomes)
+{
+    for(const CharDna* g : genomes)
+    {
+        update(*g, 1);
+    }
+}
+
+void AlleleStats::remove(const std::vector<const CharDna*>& genomes)
+{
+    for(const CharDna* g : genomes)
+    {
+        update(*g, -1);
+    }
+}
+
+double AlleleStats::entropy(uint_fast32_t locus) const
+{
+    double h = 0.0;
+    for(unsigned int k = 0; k < 8; k++)
+    {
+        h += binary_entropy(allele_frequency(locus * 8 + k));
+    }
+    return h;
+}
+
+double AlleleStats::mean_entropy() const
+{
+    if(m_loci == 0)
+    {
+        return 0.0;
+    }
+    double h = 0.0;
+    for(uint_fast32_t l = 0; l < m_loci; l++)
+    {
+        h += entropy(l);
+    }
+    return h / m_loci;
+}
+
+double AlleleStats::mean(uint_fast32_t gene) const
+{
+    if(m_individuals == 0)
+    {
+        return 0.0;
+    }
+    return static_cast<double>(m_sum[gene].to_long_double() / m_individuals);
+}
+
+double AlleleStats::variance(uint_fast32_t gene) const
+{
+    if(m_individuals == 0)
+    {
+        return 0.0;
+    }
+    long double n = static_cast<long double>(m_individuals);
+    if(m_width == fn_INT)
+    {
+        //n * sumsq - sum^2 is exact in 128 bits for 32-bit values and n < 2^32,
+        //where sum fits in 64 bits.
+        Uint128 num = m_sumsq[gene] * m_individuals - Uint128::mul(m_sum[gene].lo, m_sum[gene].lo);
+        return static_cast<double>(num.to_long_double() / (n * n));
+    }
+    long double mean = m_sum[gene].to_long_double() / n;
+    long double v = m_sumsq_long[gene] / n - mean * mean;
+    return v < 0.0L ? 0.0 : static_cast<double>(v);
+}
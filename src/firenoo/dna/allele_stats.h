@@ -0,0 +1,111 @@
+#ifndef fn_ALLELE_STATS_H
+#define fn_ALLELE_STATS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#include "char_dna.h"
+#include "uint128.h"
+
+/**
+ * Running per-locus statistics of a population, updated as genomes are
+ * inserted and removed instead of rescanned every generation.
+ *
+ * Loci are the first loci bytes of each genome; bytes past a genome's
+ * length read as 0. For every genome bit (bit j is bit j % 8 of byte j / 8,
+ * as in BitSlicedPopulation) it counts the individuals carrying a 1. Counts
+ * are kept bit-major, so one update adds bit k of 16 loci per SSE2 add into
+ * 16-bit counters, which are folded into 32-bit totals every 32767 updates.
+ *
+ * With typed_width fn_INT or fn_LONG, every aligned 32- or 64-bit unit of
+ * the loci is also tracked as a gene, read as Int32Dna or Long64Dna would,
+ * for its mean and variance. 32-bit sums are exact; 64-bit squares are
+ * summed in long double.
+ *
+ * Removing a genome that was never inserted corrupts the counts. Not
+ * thread safe.
+ */
+class AlleleStats
+{
+private:
+    uint_fast32_t m_loci;
+    unsigned int m_width;
+    size_t m_individuals;
+    //Index k * m_loci + l: bit k of byte l.
+    std::vector<uint32_t> m_counts;
+    std::vector<int16_t> m_pending;
+    uint_fast32_t m_pending_ops;
+    std::vector<Uint128> m_sum;
+    std::vector<Uint128> m_sumsq;
+    std::vector<long double> m_sumsq_long;
+    std::vector<char> m_scratch;
+
+    void update(const CharDna& genome, int sign);
+    void flush();
+
+public:
+    /**
+     * typed_width is 0 for no typed genes, or fn_INT or fn_LONG.
+     */
+    AlleleStats(uint_fast32_t loci, unsigned int typed_width = 0);
+
+    void insert(const CharDna& genome)
+    {
+        update(genome, 1);
+    }
+
+    void remove(const CharDna& genome)
+    {
+        update(genome, -1);
+    }
+
+    void insert(const std::vector<const CharDna*>& genomes);
+
+    void remove(const std::vector<const CharDna*>& genomes);
+
+    uint_fast32_t loci() const
+    {
+        return m_loci;
+    }
+
+    size_t individuals() const
+    {
+        return m_individuals;
+    }
+
+    //Individuals with genome bit set.
+    uint_fast64_t allele_count(uint_fast32_t bit) const
+    {
+        size_t i = (bit % 8) * m_loci + bit / 8;
+        return static_cast<uint_fast64_t>(static_cast<int64_t>(m_counts[i]) + m_pending[i]);
+    }
+
+    //Fraction of individuals with genome bit set, 0 for an empty population.
+    double allele_frequency(uint_fast32_t bit) const
+    {
+        return m_individuals == 0 ? 0.0 : static_cast<double>(allele_count(bit)) / m_individuals;
+    }
+
+    /**
+     * Sum of the binary entropies of the locus's 8 bits, in bits: 0 when the
+     * population agrees on the byte, 8 at most.
+     */
+    double entropy(uint_fast32_t locus) const;
+
+    //entropy() averaged over all loci.
+    double mean_entropy() const;
+
+    //Typed genes tracked: loci / typed_width.
+    uint_fast32_t genes() const
+    {
+        return static_cast<uint_fast32_t>(m_sum.size());
+    }
+
+    double mean(uint_fast32_t gene) const;
+
+    //Population variance of the gene.
+    double variance(uint_fast32_t gene) const;
+};
+
+#endif
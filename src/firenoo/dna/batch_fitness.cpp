@@ -0,0 +1,208 @@
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include "batch_fitness.h"
+#include "phase_timing.h"
+
+namespace
+{
+
+//Runs fn(t) for t in [0, threads), on threads - 1 new threads and this one.
+void run_parallel(unsigned int threads, const std::function<void(unsigned int)>& fn)
+{
+    std::vector<std::thread> workers;
+    for(unsigned int t = 1; t < threads; t++)
+    {
+        workers.emplace_back(fn, t);
+    }
+    if(threads > 0)
+    {
+        fn(0);
+    }
+    for(std::thread& w : workers)
+    {
+        w.join();
+    }
+}
+
+} //namespace
+
+void FitnessEngine::run(FitnessBatch& batch, std::vector<const CharDna*>& slice) const
+{
+    BatchLayout layout = m_fn.layout();
+    batch.bytes = nullptr;
+    batch.ints = nullptr;
+    if(layout == BATCH_GENOMES)
+    {
+        fn_PHASE_SCOPE(PHASE_FITNESS);
+        m_fn.evaluate(batch);
+        return;
+    }
+    //Transposes are layout work, not fitness, so they stay outside the timed scope.
+    slice.assign(batch.genomes, batch.genomes + batch.count);
+    if(layout == BATCH_BYTE_COLUMNS)
+    {
+        LocusColumns<char> cols = transpose_chars(slice, m_fn.loci());
+        batch.bytes = &cols;
+        fn_PHASE_SCOPE(PHASE_FITNESS);
+        m_fn.evaluate(batch);
+    } else
+    {
+        LocusColumns<uint32_t> cols = transpose_int32(slice, m_fn.loci());
+        batch.ints = &cols;
+        fn_PHASE_SCOPE(PHASE_FITNESS);
+        m_fn.evaluate(batch);
+    }
+}
+
+void FitnessEngine::evaluate_cached(const std::vector<const CharDna*>& genomes, uint_fast64_t first,
+    uint_fast64_t count, double* fitness, unsigned int threads) const
+{
+    //Look every genome up, each thread over an even share, keeping misses in order.
+    std::vector<std::vector<std::pair<uint_fast64_t, DnaHash128>>> misses(threads);
+    uint_fast64_t share = (count + threads - 1) / threads;
+    run_parallel(threads, [&](unsigned int t) {
+        uint_fast64_t begin = t * share < count ? t * share : count;
+        uint_fast64_t end = count - begin < share ? count : begin + share;
+        for(uint_fast64_t i = begin; i < end; i++)
+        {
+            const CharDna& g = *genomes[first + i];
+            DnaHash128 key = FitnessCache::key(g);
+            if(!m_cache->lookup(key, g, fitness[i]))
+            {
+                misses[t].emplace_back(i, key);
+            }
+        }
+    });
+
+    //One entry per distinct genome; later copies take its result as
+    //(offset into fitness, entry).
+    std::vector<const CharDna*> pending;
+    std::vector<uint_fast64_t> indices;
+    std::vector<DnaHash128> keys;
+    std::vector<std::pair<uint_fast64_t, size_t>> copies;
+    std::unordered_multimap<uint64_t, size_t> slots;
+    for(const std::vector<std::pair<uint_fast64_t, DnaHash128>>& part : misses)
+    {
+        for(const std::pair<uint_fast64_t, DnaHash128>& m : part)
+        {
+            const CharDna& g = *genomes[first + m.first];
+            bool copy = false;
+            auto range = slots.equal_range(m.second.lo);
+            for(auto it = range.first; it != range.second && !copy; ++it)
+            {
+                const CharDna& p = *pending[it->second];
+                if(keys[it->second] == m.second && (!m_cache->verify() || (p.seed() == g.seed()
+                    && p.len() == g.len() && memcmp(p.all_data(), g.all_data(), g.len()) == 0)))
+                {
+                    copies.emplace_back(m.first, it->second);
+                    copy = true;
+                }
+            }
+            if(!copy)
+            {
+                slots.emplace(m.second.lo, pending.size());
+                pending.push_back(&g);
+                indices.push_back(first + m.first);
+                keys.push_back(m.second);
+            }
+        }
+    }
+
+    //Cut the misses into full batches, claimed one at a time.
+    std::vector<double> scores(pending.size());
+    uint_fast64_t batches = (pending.size() + m_batch_size - 1) / m_batch_size;
+    std::atomic<uint_fast64_t> next(0);
+    run_parallel(threads < batches ? threads : static_cast<unsigned int>(batches), [&](unsigned int) {
+        std::vector<const CharDna*> slice;
+        FitnessBatch batch;
+        for(uint_fast64_t b = next.fetch_add(1); b < batches; b = next.fetch_add(1))
+        {
+            size_t at = b * m_batch_size;
+            size_t n = pending.size() - at < m_batch_size ? pending.size() - at : m_batch_size;
+            batch.first = indices[at];
+            batch.count = static_cast<uint_fast32_t>(n);
+            batch.genomes = pending.data() + at;
+            batch.indices = indices.data() + at;
+            batch.fitness = scores.data() + at;
+            run(batch, slice);
+            for(size_t j = at; j < at + n; j++)
+            {
+                fitness[indices[j] - first] = scores[j];
+                m_cache->insert(keys[j], *pending[j], scores[j]);
+            }
+        }
+    });
+    for(const std::pair<uint_fast64_t, size_t>& c : copies)
+    {
+        fitness[c.first] = scores[c.second];
+    }
+}
+
+void FitnessEngine::evaluate(const std::vector<const CharDna*>& genomes, uint_fast64_t first, uint_fast64_t count,
+    double* fitness) const
+{
+    if(m_cache != nullptr)
+    {
+        evaluate_cached(genomes, first, count, fitness, 1);
+        return;
+    }
+    std::vector<const CharDna*> slice;
+    FitnessBatch batch;
+    for(uint_fast64_t done = 0; done < count; done += m_batch_size)
+    {
+        batch.first = first + done;
+        batch.count = static_cast<uint_fast32_t>(count - done < m_batch_size ? count - done : m_batch_size);
+        batch.genomes = genomes.data() + batch.first;
+        batch.indices = nullptr;
+        batch.fitness = fitness + done;
+        run(batch, slice);
+    }
+}
+
+void FitnessEngine::evaluate(const std::vector<const CharDna*>& genomes, std::vector<double>& fitness,
+    unsigned int threads) const
+{
+    fitness.resize(genomes.size());
+    if(threads == 0)
+    {
+        threads = std::thread::hardware_concurrency();
+    }
+    uint_fast64_t batches = (genomes.size() + m_batch_size - 1) / m_batch_size;
+    if(threads > batches)
+    {
+        threads = static_cast<unsigned int>(batches);
+    }
+    if(threads <= 1)
+    {
+        evaluate(genomes, 0, genomes.size(), fitness.data());
+        return;
+    }
+    if(m_cache != nullptr)
+    {
+        evaluate_cached(genomes, 0, genomes.size(), fitness.data(), threads);
+        return;
+    }
+    //Batches are claimed one at a time so slow ones do not hold up a thread's share.
+    std::atomic<uint_fast64_t> next(0);
+    run_parallel(threads, [&](unsigned int) {
+        for(uint_fast64_t b = next.fetch_add(1); b < batches; b = next.fetch_add(1))
+        {
+            uint_fast64_t first = b * m_batch_size;
+            uint_fast64_t n = genomes.size() - first < m_batch_size ? genomes.size() - first : m_batch_size;
+            evaluate(genomes, first, n, fitness.data() + first);
+        }
+    });
+}
+
+std::function<void(GenomeBatch&)> FitnessEngine::stage(const std::vector<const CharDna*>& genomes) const
+{
+    const FitnessEngine* engine = this;
+    const std::vector<const CharDna*>* pop = &genomes;
+    return [engine, pop](GenomeBatch& b) {
+        engine->evaluate(*pop, b.first, b.count, b.fitness.data());
+    };
+}
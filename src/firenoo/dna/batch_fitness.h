@@ -0,0 +1,137 @@
+#ifndef fn_BATCH_FITNESS_H
+#define fn_BATCH_FITNESS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <functional>
+#include <vector>
+
+#include "char_dna.h"
+#include "fitness_cache.h"
+#include "pipeline.h"
+#include "transpose.h"
+
+//Batched fitness evaluation. An evaluator receives a whole batch of genomes
+//per call instead of one genome, so per-call setup, simulator round trips or
+//GPU launches are paid once per batch. The engine cuts the population into
+//batches and, if asked, hands them over locus-major for SIMD scoring.
+
+/**
+ * How an evaluator wants its batches laid out. Every batch carries the
+ * genome views; the column layouts add a locus-major copy of them.
+ */
+enum BatchLayout
+{
+    BATCH_GENOMES,
+    //Byte loci, as transpose_chars().
+    BATCH_BYTE_COLUMNS,
+    //32-bit loci, as transpose_int32().
+    BATCH_INT32_COLUMNS
+};
+
+/**
+ * One call's worth of genomes. genomes[i] is population index first + i, or
+ * indices[i] when indices is set, as for the cache misses of a range. bytes
+ * or ints is set for the matching layout and null otherwise; their
+ * columns are count individuals long. The evaluator writes fitness[i] for
+ * every i < count.
+ */
+struct FitnessBatch
+{
+    uint_fast64_t first;
+    uint_fast32_t count;
+    const CharDna* const* genomes;
+    const uint_fast64_t* indices;
+    const LocusColumns<char>* bytes;
+    const LocusColumns<uint32_t>* ints;
+    double* fitness;
+};
+
+/**
+ * Fitness plugin. evaluate() may be called concurrently on different batches
+ * when the engine runs on several threads.
+ */
+class BatchFitness
+{
+public:
+    virtual ~BatchFitness()
+    {
+    }
+
+    virtual BatchLayout layout() const
+    {
+        return BATCH_GENOMES;
+    }
+
+    /**
+     * Loci to transpose for the column layouts, in bytes or in 32-bit units.
+     */
+    virtual uint_fast32_t loci() const
+    {
+        return 0;
+    }
+
+    virtual void evaluate(const FitnessBatch& batch) = 0;
+};
+
+/**
+ * Drives a BatchFitness over a population in batches of batch_size genomes.
+ * Each call to the plugin's evaluate() is timed as PHASE_FITNESS, one sample
+ * per batch, so evaluators need not time themselves. Hashing, cache lookups
+ * and transposes are not included.
+ *
+ * With a cache, every genome of the range is looked up first, and only the
+ * misses of the whole range are cut into batches, so plugin batches stay
+ * full however high the hit rate. Copies of a genome within the range are
+ * evaluated once. Results are stored back into the cache.
+ */
+class FitnessEngine
+{
+private:
+    BatchFitness& m_fn;
+    uint_fast32_t m_batch_size;
+    FitnessCache* m_cache;
+
+    //Adds the batch's column layout, if any, and calls the evaluator.
+    void run(FitnessBatch& batch, std::vector<const CharDna*>& slice) const;
+
+    //Cache lookups, then batches of the misses, both over threads.
+    void evaluate_cached(const std::vector<const CharDna*>& genomes, uint_fast64_t first, uint_fast64_t count,
+        double* fitness, unsigned int threads) const;
+
+public:
+    FitnessEngine(BatchFitness& fn, uint_fast32_t batch_size = 256, FitnessCache* cache = nullptr) :
+        m_fn(fn),
+        m_batch_size(batch_size == 0 ? 1 : batch_size),
+        m_cache(cache)
+    {
+    }
+
+    uint_fast32_t batch_size() const
+    {
+        return m_batch_size;
+    }
+
+    /**
+     * Scores genomes [first, first + count) into fitness[0, count) on the
+     * calling thread.
+     */
+    void evaluate(const std::vector<const CharDna*>& genomes, uint_fast64_t first, uint_fast64_t count,
+        double* fitness) const;
+
+    /**
+     * Scores the whole population, resizing fitness to match. Batches are
+     * shared out among threads; 0 uses hardware_concurrency().
+     */
+    void evaluate(const std::vector<const CharDna*>& genomes, std::vector<double>& fitness,
+        unsigned int threads = 1) const;
+
+    /**
+     * Fitness stage for GenerationPipeline over genomes. Pipeline batches
+     * larger than batch_size() are split. genomes and the engine must outlive
+     * the pipeline run.
+     */
+    std::function<void(GenomeBatch&)> stage(const std::vector<const CharDna*>& genomes) const;
+};
+
+#endif
@@ -0,0 +1,853 @@
+//Microbenchmarks for the DNA primitives. Results are written as CSV so runs
+//can be stored and compared against a baseline:
+//
+//  dna_bench [--out FILE] [--baseline FILE] [--threshold PCT] [--quick]
+//
+//Each row is: name,bytes,iters,ns_per_op,mb_per_s
+//With --baseline, every case that is slower than the baseline by more than
+//the threshold (default 10%) is reported and the exit status is 1.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include "../dna.h"
+
+namespace
+{
+
+//Exposes the protected realloc() for measurement.
+class BenchDna : public CharDna
+{
+public:
+    using CharDna::CharDna;
+    using CharDna::realloc;
+};
+
+struct Result
+{
+    std::string name;
+    uint_fast64_t bytes;
+    uint_fast64_t iters;
+    double ns_per_op;
+    double mb_per_s;
+};
+
+//Sink that keeps the optimizer from discarding benchmarked work.
+volatile uint_fast64_t g_sink = 0;
+
+double g_min_time = 0.05; //seconds per sample
+const unsigned int kSamples = 5;
+
+/**
+ * Runs fn repeatedly until a sample lasts at least g_min_time, for kSamples
+ * samples. Returns the median nanoseconds per call. fn is called with the
+ * number of calls to perform and returns the number of ops it did.
+ */
+double measure(const std::function<uint_fast64_t(uint_fast64_t)>& fn, uint_fast64_t& iters_out)
+{
+    typedef std::chrono::steady_clock clock;
+    uint_fast64_t iters = 1;
+    //Calibrate the iteration count.
+    for(;;)
+    {
+        clock::time_point t0 = clock::now();
+        fn(iters);
+        double secs = std::chrono::duration<double>(clock::now() - t0).count();
+        if(secs >= g_min_time || iters >= (1ull << 40))
+        {
+            break;
+        }
+        if(secs <= 0)
+        {
+            iters *= 10;
+        } else
+        {
+            uint_fast64_t next = static_cast<uint_fast64_t>(iters * (g_min_time * 1.2 / secs));
+            iters = std::max(next, iters * 2);
+        }
+    }
+    std::vector<double> samples;
+    uint_fast64_t ops = 0;
+    for(unsigned int s = 0; s < kSamples; s++)
+    {
+        clock::time_point t0 = clock::now();
+        ops = fn(iters);
+        double ns = std::chrono::duration<double, std::nano>(clock::now() - t0).count();
+        samples.push_back(ns / static_cast<double>(ops));
+    }
+    std::sort(samples.begin(), samples.end());
+    iters_out = ops;
+    return samples[kSamples / 2];
+}
+
+void record(std::vector<Result>& out, const std::string& name, uint_fast64_t bytes,
+    const std::function<uint_fast64_t(uint_fast64_t)>& fn)
+{
+    Result r;
+    r.name = name;
+    r.bytes = bytes;
+    r.ns_per_op = measure(fn, r.iters);
+    //Throughput relative to the genome size each op touches.
+    r.mb_per_s = bytes == 0 ? 0.0 : (static_cast<double>(bytes) / r.ns_per_op) * 1e3;
+    out.push_back(r);
+}
+
+//size / genome bytes genomes, genome i with seed i and every byte i. owned
+//keeps them alive; genomes gets a view of each.
+void make_population(uint_fast32_t size, uint_fast32_t genome, std::vector<std::unique_ptr<CharDna>>& owned,
+    std::vector<const CharDna*>& genomes)
+{
+    for(uint_fast32_t i = 0; i < size / genome; i++)
+    {
+        owned.emplace_back(new CharDna(i, genome, std::string(genome, static_cast<char>(i)).c_str()));
+        genomes.push_back(owned.back().get());
+    }
+}
+
+void bench_char(std::vector<Result>& out, uint_fast32_t size)
+{
+    //Overwrite an already sized genome; no reallocation.
+    record(out, "CharDna::set_char", size, [size](uint_fast64_t n) {
+        CharDna d(0, size);
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            for(uint_fast32_t i = 0; i < size; i++)
+            {
+                d.set_char(i, static_cast<char>(i + k));
+            }
+        }
+        g_sink += d.char_data(size - 1);
+        return n;
+    });
+    //Grow from a single unit; includes capacity doubling.
+    record(out, "CharDna::append_char", size, [size](uint_fast64_t n) {
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            CharDna d(0, CharDna::unit_size);
+            for(uint_fast32_t i = 0; i < size; i++)
+            {
+                d.append_char(static_cast<char>(i));
+            }
+            g_sink += d.len();
+        }
+        return n;
+    });
+    //Same with cache line units and aligned buffers.
+    record(out, "LineDna::append_char", size, [size](uint_fast64_t n) {
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            LineDna d(0, LineDna::unit_size);
+            for(uint_fast32_t i = 0; i < size; i++)
+            {
+                d.append_char(static_cast<char>(i));
+            }
+            g_sink += d.len();
+        }
+        return n;
+    });
+    record(out, "CharDna::realloc", size, [size](uint_fast64_t n) {
+        BenchDna d(0, size, std::string(size, 'x').c_str());
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            //Alternate so every call copies size bytes.
+            d.realloc(k & 1 ? size : size * 2);
+        }
+        g_sink += d.capacity();
+        return n;
+    });
+}
+
+void bench_typed(std::vector<Result>& out, uint_fast32_t size)
+{
+    if(size < 8)
+    {
+        return;
+    }
+    record(out, "Int32Dna::append_int", size, [size](uint_fast64_t n) {
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            std::shared_ptr<CharDna> d = std::make_shared<CharDna>(0, size);
+            Int32Dna w(d);
+            for(uint_fast32_t i = 0; i < size / 4; i++)
+            {
+                w.append_int(i);
+            }
+            g_sink += d->len();
+        }
+        return n;
+    });
+    {
+        std::shared_ptr<CharDna> d = std::make_shared<CharDna>(0, size);
+        Int32Dna w(d);
+        for(uint_fast32_t i = 0; i < size / 4; i++)
+        {
+            w.append_int(i);
+        }
+        record(out, "Int32Dna::int_data", size, [size, w](uint_fast64_t n) {
+            uint_fast64_t acc = 0;
+            for(uint_fast64_t k = 0; k < n; k++)
+            {
+                for(uint_fast32_t i = 0; i < size / 4; i++)
+                {
+                    acc += w.int_data(i);
+                }
+            }
+            g_sink += acc;
+            return n;
+        });
+    }
+    record(out, "Long64Dna::append_long", size, [size](uint_fast64_t n) {
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            std::shared_ptr<CharDna> d = std::make_shared<CharDna>(0, size);
+            Long64Dna w(d);
+            for(uint_fast32_t i = 0; i < size / 8; i++)
+            {
+                w.append_long(i);
+            }
+            g_sink += d->len();
+        }
+        return n;
+    });
+    {
+        std::shared_ptr<CharDna> d = std::make_shared<CharDna>(0, size);
+        Long64Dna w(d);
+        for(uint_fast32_t i = 0; i < size / 8; i++)
+        {
+            w.append_long(i);
+        }
+        record(out, "Long64Dna::long_data", size, [size, w](uint_fast64_t n) {
+            uint_fast64_t acc = 0;
+            for(uint_fast64_t k = 0; k < n; k++)
+            {
+                for(uint_fast32_t i = 0; i < size / 8; i++)
+                {
+                    acc += w.long_data(i);
+                }
+            }
+            g_sink += acc;
+            return n;
+        });
+    }
+}
+
+void bench_gene(std::vector<Result>& out)
+{
+    record(out, "Gene::append_64", 0, [](uint_fast64_t n) {
+        Gene g;
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            g.append_64(k, ~k, 1, 0, true);
+            g_sink += g.get_data()[1];
+        }
+        return n;
+    });
+    record(out, "Gene::append_32", 0, [](uint_fast64_t n) {
+        Gene g;
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            g.clear_data();
+            g.append_32(k, ~k, 1, 0, false);
+            g.append_32(~k, k, 0, 1, false);
+            g_sink += g.get_data()[1];
+        }
+        return n * 2;
+    });
+    record(out, "Gene::append_16", 0, [](uint_fast64_t n) {
+        Gene g;
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            g.clear_data();
+            g.append_16(k & 0xffff, ~k & 0xffff, 1, 0, false);
+            g.append_16(~k & 0xffff, k & 0xffff, 0, 1, false);
+            g_sink += g.get_data()[1];
+        }
+        return n * 2;
+    });
+}
+
+void bench_io(std::vector<Result>& out, uint_fast32_t size, const std::string& path)
+{
+    CharDna d(7, size, std::string(size, 'x').c_str());
+    record(out, "serialize", size, [&d, &path](uint_fast64_t n) {
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            serialize(path, {&d});
+        }
+        return n;
+    });
+    record(out, "deserialize", size, [&path](uint_fast64_t n) {
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            std::vector<CharDna> vec;
+            vec.reserve(1);
+            deserialize(path, vec);
+            g_sink += vec.size();
+        }
+        return n;
+    });
+    std::remove(path.c_str());
+}
+
+//Population of size bytes in 256-byte genomes, restarted from an image.
+void bench_image(std::vector<Result>& out, uint_fast32_t size, const std::string& path)
+{
+    const uint_fast32_t kGenome = 256;
+    if(size < kGenome)
+    {
+        return;
+    }
+    std::vector<std::unique_ptr<CharDna>> owned;
+    std::vector<const CharDna*> genomes;
+    make_population(size, kGenome, owned, genomes);
+    std::vector<Gene> genes(genomes.size());
+    record(out, "write_population_image", size, [&](uint_fast64_t n) {
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            g_sink += write_population_image(path, genomes, genes);
+        }
+        return n;
+    });
+    //Open and touch the last byte of every genome.
+    record(out, "PopulationImage::open", size, [&path](uint_fast64_t n) {
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            PopulationImage image;
+            image.open(path);
+            for(size_t i = 0; i < image.size(); i++)
+            {
+                g_sink += image.data(i)[image.len(i) - 1];
+            }
+        }
+        return n;
+    });
+    std::remove(path.c_str());
+}
+
+//Two-parent offspring of size bytes with one crossover point and a 4-byte patch.
+void bench_delta(std::vector<Result>& out, uint_fast32_t size)
+{
+    if(size < 8)
+    {
+        return;
+    }
+    DeltaDna::Ptr a = DeltaDna::from_genome(CharDna(1, size, std::string(size, 'a').c_str()));
+    DeltaDna::Ptr b = DeltaDna::from_genome(CharDna(2, size, std::string(size, 'b').c_str()));
+    std::vector<uint_fast32_t> points(1, size / 2);
+    std::vector<DnaPatch> patches(1);
+    patches[0].offset = size / 3;
+    patches[0].bytes.assign(4, 'x');
+    record(out, "DeltaDna::offspring", size, [&](uint_fast64_t n) {
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            g_sink += DeltaDna::offspring(k, size, a, b, points, patches)->len();
+        }
+        return n;
+    });
+    DeltaDna::Ptr child = DeltaDna::offspring(3, size, a, b, points, patches);
+    record(out, "DeltaDna::materialize", size, [&child](uint_fast64_t n) {
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            g_sink += child->materialize().len();
+        }
+        return n;
+    });
+}
+
+//A population of size bytes in 256-byte genomes: append_char vs random_population.
+void bench_init(std::vector<Result>& out, uint_fast32_t size)
+{
+    const uint_fast32_t kGenome = 256;
+    if(size < kGenome)
+    {
+        return;
+    }
+    std::vector<uint_fast64_t> seeds(size / kGenome);
+    for(size_t i = 0; i < seeds.size(); i++)
+    {
+        seeds[i] = i;
+    }
+    record(out, "init/append_char", size, [&](uint_fast64_t n) {
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            std::vector<CharDna> pop;
+            pop.reserve(seeds.size());
+            uint_fast64_t state = k;
+            for(uint_fast64_t seed : seeds)
+            {
+                pop.emplace_back(seed, kGenome);
+                for(uint_fast32_t i = 0; i < kGenome; i++)
+                {
+                    state = state * 6364136223846793005ull + 1442695040888963407ull;
+                    pop.back().append_char(static_cast<char>(state >> 56));
+                }
+            }
+            g_sink += pop.back().char_data(0);
+        }
+        return n;
+    });
+    record(out, "init/random_population", size, [&](uint_fast64_t n) {
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            g_sink += random_population(seeds, kGenome).back().char_data(0);
+        }
+        return n;
+    });
+}
+
+//One 4-byte insertion and deletion at a random offset of a size byte genome.
+void bench_rope(std::vector<Result>& out, uint_fast32_t size)
+{
+    std::string init(size, 'r');
+    record(out, "indel/shift", size, [&init, size](uint_fast64_t n) {
+        std::string g = init;
+        uint_fast64_t state = 1;
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+            size_t at = static_cast<size_t>((state >> 33) % size);
+            g.insert(at, "abcd", 4);
+            g.erase(at, 4);
+        }
+        g_sink += g.size();
+        return n;
+    });
+    RopeDna rope(CharDna(0, size, init.c_str()));
+    record(out, "indel/RopeDna", size, [&rope, size](uint_fast64_t n) {
+        uint_fast64_t state = 1;
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+            uint_fast32_t at = static_cast<uint_fast32_t>((state >> 33) % size);
+            rope.insert(at, "abcd", 4);
+            rope.erase(at, 4);
+        }
+        g_sink += rope.len();
+        return n;
+    });
+}
+
+//Byte sum over a size byte genome with one non-zero unit in 32.
+void bench_sparse(std::vector<Result>& out, uint_fast32_t size)
+{
+    CharDna dense(0, size);
+    char* p = dense.resize(size);
+    for(uint_fast32_t i = 0; i < size; i += CharDna::unit_size * 32)
+    {
+        p[i] = 1;
+    }
+    SparseDna sparse = SparseDna::from_dense(dense);
+    record(out, "scan/CharDna", size, [&dense, size](uint_fast64_t n) {
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            const char* d = dense.all_data();
+            uint_fast64_t sum = 0;
+            for(uint_fast32_t i = 0; i < size; i++)
+            {
+                sum += static_cast<unsigned char>(d[i]);
+            }
+            g_sink += sum;
+        }
+        return n;
+    });
+    record(out, "scan/SparseDna", size, [&sparse](uint_fast64_t n) {
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            uint_fast64_t sum = 0;
+            for(size_t u = 0; u < sparse.units(); u++)
+            {
+                const char* d = sparse.unit_data(u);
+                for(uint_fast32_t i = 0; i < SparseDna::unit_size; i++)
+                {
+                    sum += static_cast<unsigned char>(d[i]);
+                }
+            }
+            g_sink += sum;
+        }
+        return n;
+    });
+}
+
+//Interning a size byte payload that is already stored: hash plus full compare.
+void bench_store(std::vector<Result>& out, uint_fast32_t size)
+{
+    std::string payload(size, 's');
+    GenomeStore store;
+    uint_fast64_t id = store.intern(payload.data(), size);
+    record(out, "GenomeStore::intern", size, [&](uint_fast64_t n) {
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            g_sink += store.intern(payload.data(), size);
+            store.release(id);
+        }
+        return n;
+    });
+}
+
+//size / 16 (key, index) pairs, as ranked by fitness.
+void bench_rank(std::vector<Result>& out, uint_fast32_t size)
+{
+    size_t n = size / sizeof(RankEntry);
+    if(n < 2)
+    {
+        return;
+    }
+    std::vector<double> fitness(n);
+    uint_fast64_t state = 1;
+    for(size_t i = 0; i < n; i++)
+    {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        fitness[i] = static_cast<double>(state >> 11) / 9007199254740992.0;
+    }
+    record(out, "std::sort", size, [&fitness](uint_fast64_t k) {
+        for(uint_fast64_t r = 0; r < k; r++)
+        {
+            std::vector<uint64_t> order(fitness.size());
+            for(size_t i = 0; i < order.size(); i++)
+            {
+                order[i] = i;
+            }
+            std::sort(order.begin(), order.end(), [&fitness](uint64_t a, uint64_t b) {
+                return fitness[a] > fitness[b];
+            });
+            g_sink += order[0];
+        }
+        return k;
+    });
+    record(out, "rank_by_fitness", size, [&fitness](uint_fast64_t k) {
+        for(uint_fast64_t r = 0; r < k; r++)
+        {
+            g_sink += rank_by_fitness(fitness, true)[0];
+        }
+        return k;
+    });
+    record(out, "top_k_by_fitness", size, [&fitness](uint_fast64_t k) {
+        for(uint_fast64_t r = 0; r < k; r++)
+        {
+            g_sink += top_k_by_fitness(fitness, fitness.size() / 100 + 1, true)[0];
+        }
+        return k;
+    });
+}
+
+//Population of size bytes total, split into 256-byte genomes.
+void bench_transpose(std::vector<Result>& out, uint_fast32_t size)
+{
+    const uint_fast32_t kGenome = 256;
+    if(size < kGenome * 16)
+    {
+        return;
+    }
+    std::vector<std::unique_ptr<CharDna>> owned;
+    std::vector<const CharDna*> genomes;
+    make_population(size, kGenome, owned, genomes);
+    record(out, "transpose_chars", size, [&genomes](uint_fast64_t n) {
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            g_sink += transpose_chars(genomes, kGenome).at(kGenome - 1, 0);
+        }
+        return n;
+    });
+    record(out, "transpose_int32", size, [&genomes](uint_fast64_t n) {
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            g_sink += transpose_int32(genomes, kGenome / 4).at(kGenome / 4 - 1, 0);
+        }
+        return n;
+    });
+}
+
+//Same population shape as bench_transpose, bit-sliced.
+void bench_bitslice(std::vector<Result>& out, uint_fast32_t size)
+{
+    const uint_fast32_t kGenome = 256;
+    if(size < kGenome * 16)
+    {
+        return;
+    }
+    std::vector<std::unique_ptr<CharDna>> owned;
+    std::vector<const CharDna*> genomes;
+    make_population(size, kGenome, owned, genomes);
+    BitSlicedPopulation pop = BitSlicedPopulation::from_genomes(genomes, kGenome);
+    record(out, "BitSlicedPopulation::mutate", size, [&pop](uint_fast64_t n) {
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            pop.mutate(4, k);
+        }
+        g_sink += pop.plane(0)[0];
+        return n;
+    });
+    record(out, "BitSlicedPopulation::allele_counts", size, [&pop](uint_fast64_t n) {
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            g_sink += pop.allele_counts()[0];
+        }
+        return n;
+    });
+}
+
+//Sum of bytes per genome, read through the genome views.
+class ByteSumFitness : public BatchFitness
+{
+private:
+    uint_fast32_t m_loci;
+
+public:
+    explicit ByteSumFitness(uint_fast32_t loci) :
+        m_loci(loci)
+    {
+    }
+
+    void evaluate(const FitnessBatch& batch) override
+    {
+        for(uint_fast32_t i = 0; i < batch.count; i++)
+        {
+            const char* d = batch.genomes[i]->all_data();
+            uint_fast64_t sum = 0;
+            for(uint_fast32_t l = 0; l < m_loci; l++)
+            {
+                sum += static_cast<unsigned char>(d[l]);
+            }
+            batch.fitness[i] = static_cast<double>(sum);
+        }
+    }
+};
+
+//Same sum over locus-major columns: the inner loop runs across individuals.
+class ColumnSumFitness : public BatchFitness
+{
+private:
+    uint_fast32_t m_loci;
+    std::vector<uint_fast64_t> m_sums;
+
+public:
+    explicit ColumnSumFitness(uint_fast32_t loci) :
+        m_loci(loci)
+    {
+    }
+
+    BatchLayout layout() const override
+    {
+        return BATCH_BYTE_COLUMNS;
+    }
+
+    uint_fast32_t loci() const override
+    {
+        return m_loci;
+    }
+
+    //Single-threaded use only: m_sums is shared scratch.
+    void evaluate(const FitnessBatch& batch) override
+    {
+        m_sums.assign(batch.count, 0);
+        for(uint_fast32_t l = 0; l < m_loci; l++)
+        {
+            const char* col = batch.bytes->column(l);
+            for(uint_fast32_t i = 0; i < batch.count; i++)
+            {
+                m_sums[i] += static_cast<unsigned char>(col[i]);
+            }
+        }
+        for(uint_fast32_t i = 0; i < batch.count; i++)
+        {
+            batch.fitness[i] = static_cast<double>(m_sums[i]);
+        }
+    }
+};
+
+//One genome of size bytes replaced in a running population summary.
+void bench_allele_stats(std::vector<Result>& out, uint_fast32_t size)
+{
+    CharDna a(1, size, std::string(size, 'a').c_str());
+    CharDna b(2, size, std::string(size, 'b').c_str());
+    AlleleStats stats(size);
+    stats.insert(a);
+    record(out, "AlleleStats::insert+remove", size, [&](uint_fast64_t n) {
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            stats.insert(b);
+            stats.remove(a);
+            stats.insert(a);
+            stats.remove(b);
+        }
+        g_sink += stats.allele_count(0);
+        return n * 2;
+    });
+}
+
+//Same population shape as bench_transpose, scored in batches of 256.
+void bench_fitness(std::vector<Result>& out, uint_fast32_t size)
+{
+    const uint_fast32_t kGenome = 256;
+    if(size < kGenome * 16)
+    {
+        return;
+    }
+    std::vector<std::unique_ptr<CharDna>> owned;
+    std::vector<const CharDna*> genomes;
+    make_population(size, kGenome, owned, genomes);
+    std::vector<double> fitness;
+    ByteSumFitness rows(kGenome);
+    ColumnSumFitness cols(kGenome);
+    FitnessEngine row_engine(rows);
+    FitnessEngine col_engine(cols);
+    FitnessCache cache(genomes.size());
+    FitnessEngine cached_engine(rows, 256, &cache);
+    cached_engine.evaluate(genomes, fitness);
+    record(out, "FitnessEngine/genomes", size, [&](uint_fast64_t n) {
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            row_engine.evaluate(genomes, fitness);
+            g_sink += static_cast<uint_fast64_t>(fitness[0]);
+        }
+        return n;
+    });
+    record(out, "FitnessEngine/columns", size, [&](uint_fast64_t n) {
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            col_engine.evaluate(genomes, fitness);
+            g_sink += static_cast<uint_fast64_t>(fitness[0]);
+        }
+        return n;
+    });
+    //Every genome already cached: one hash and lookup each.
+    record(out, "FitnessEngine/cached", size, [&](uint_fast64_t n) {
+        for(uint_fast64_t k = 0; k < n; k++)
+        {
+            cached_engine.evaluate(genomes, fitness);
+            g_sink += static_cast<uint_fast64_t>(fitness[0]);
+        }
+        return n;
+    });
+}
+
+void write_csv(std::ostream& os, const std::vector<Result>& results)
+{
+    os << "name,bytes,iters,ns_per_op,mb_per_s\n";
+    for(const Result& r : results)
+    {
+        os << r.name << ',' << r.bytes << ',' << r.iters << ','
+           << r.ns_per_op << ',' << r.mb_per_s << '\n';
+    }
+}
+
+//Reads name,bytes -> ns_per_op from a CSV previously written by write_csv.
+bool read_baseline(const std::string& path, std::map<std::pair<std::string, uint_fast64_t>, double>& out)
+{
+    std::ifstream file(path);
+    if(!file.is_open())
+    {
+        return false;
+    }
+    std::string line;
+    std::getline(file, line); //header
+    while(std::getline(file, line))
+    {
+        std::istringstream row(line);
+        std::string name, bytes, iters, ns;
+        if(std::getline(row, name, ',') && std::getline(row, bytes, ',')
+            && std::getline(row, iters, ',') && std::getline(row, ns, ','))
+        {
+            out[std::make_pair(name, std::stoull(bytes))] = std::stod(ns);
+        }
+    }
+    return true;
+}
+
+} //namespace
+
+int main(int argc, char** argv)
+{
+    std::string out_path;
+    std::string baseline_path;
+    double threshold = 10.0;
+    uint_fast32_t max_size = 16u << 20;
+    for(int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if(arg == "--out" && i + 1 < argc)
+        {
+            out_path = argv[++i];
+        } else if(arg == "--baseline" && i + 1 < argc)
+        {
+            baseline_path = argv[++i];
+        } else if(arg == "--threshold" && i + 1 < argc)
+        {
+            threshold = std::stod(argv[++i]);
+        } else if(arg == "--quick")
+        {
+            g_min_time = 0.005;
+            max_size = 1u << 20;
+        } else
+        {
+            std::cerr << "usage: " << argv[0]
+                      << " [--out FILE] [--baseline FILE] [--threshold PCT] [--quick]" << std::endl;
+            return 2;
+        }
+    }
+
+    std::vector<Result> results;
+    bench_gene(results);
+    //16 B to 16 MB in steps of 4x.
+    for(uint_fast32_t size = 16; size <= max_size; size *= 4)
+    {
+        bench_char(results, size);
+        bench_typed(results, size);
+        bench_io(results, size, "dna_bench.bin");
+        bench_image(results, size, "dna_bench.img");
+        bench_rank(results, size);
+        bench_delta(results, size);
+        bench_store(results, size);
+        bench_init(results, size);
+        bench_rope(results, size);
+        bench_sparse(results, size);
+        bench_transpose(results, size);
+        bench_bitslice(results, size);
+        bench_fitness(results, size);
+        bench_allele_stats(results, size);
+    }
+
+    if(out_path.empty())
+    {
+        write_csv(std::cout, results);
+    } else
+    {
+        std::ofstream file(out_path, std::ios::trunc);
+        write_csv(file, results);
+    }
+
+    if(baseline_path.empty())
+    {
+        return 0;
+    }
+    std::map<std::pair<std::string, uint_fast64_t>, double> baseline;
+    if(!read_baseline(baseline_path, baseline))
+    {
+        std::cerr << "cannot read baseline " << baseline_path << std::endl;
+        return 2;
+    }
+    int regressions = 0;
+    for(const Result& r : results)
+    {
+        auto it = baseline.find(std::make_pair(r.name, r.bytes));
+        if(it == baseline.end() || it->second <= 0)
+        {
+            continue;
+        }
+        double delta = (r.ns_per_op / it->second - 1.0) * 100.0;
+        if(delta > threshold)
+        {
+            std::cerr << "REGRESSION " << r.name << " @" << r.bytes << "B: "
+                      << it->second << " -> " << r.ns_per_op << " ns/op (+"
+                      << delta << "%)" << std::endl;
+            regressions++;
+        }
+    }
+    return regressions == 0 ? 0 : 1;
+}
@@ -0,0 +1,367 @@
+//End-to-end throughput benchmark: builds populations of CharDna genomes and
+//runs full synthetic generations (decode, score, select, breed) at 1, 2, 4,
+//... N threads. Output is CSV:
+//
+//  genomes,threads,genome_bytes,generations,seconds,genomes_per_s,bytes_alloc,peak_rss_kb,mode
+//
+//  population_bench [--min N] [--max N] [--threads N] [--bytes B] [--gens G]
+//                   [--fitness-us U] [--pipeline 1]
+//
+//Population sizes step by 10x from --min (default 10000) to --max (default
+//1000000; pass 10000000 for the full range). bytes_alloc is taken from
+//DnaStats when built with fn_DNA_STATS, and otherwise is the capacity of the
+//genomes the generations created. peak_rss_kb is VmHWM, reset between runs
+//where the kernel allows it.
+//
+//--fitness-us adds a sleep per genome to the fitness phase, standing in for
+//a slow external simulator. --pipeline 1 runs each generation through
+//GenerationPipeline instead of phase-by-phase; the mode is the last column.
+//Pipeline runs split the threads across the stages, but start at least one
+//per stage, so their threads column is never below 4.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../dna.h"
+
+namespace
+{
+
+typedef std::vector<std::shared_ptr<CharDna>> Population;
+
+unsigned int g_fitness_us = 0;
+bool g_pipeline = false;
+
+uint_fast64_t splitmix64(uint_fast64_t& state)
+{
+    uint_fast64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+//Runs fn(begin, end, thread index) over [0, n) split across threads.
+template<typename Fn>
+void parallel_for(uint_fast32_t n, unsigned int threads, Fn fn)
+{
+    std::vector<std::thread> pool;
+    uint_fast32_t chunk = (n + threads - 1) / threads;
+    for(unsigned int t = 0; t < threads; t++)
+    {
+        uint_fast32_t begin = std::min<uint_fast32_t>(n, t * chunk);
+        uint_fast32_t end = std::min<uint_fast32_t>(n, begin + chunk);
+        pool.emplace_back(fn, begin, end, t);
+    }
+    for(std::thread& th : pool)
+    {
+        th.join();
+    }
+}
+
+std::shared_ptr<CharDna> random_genome(uint_fast64_t seed, uint_fast32_t bytes)
+{
+    std::shared_ptr<CharDna> d = std::make_shared<CharDna>(seed, bytes);
+    Int32Dna w(d);
+    uint_fast64_t state = seed;
+    for(uint_fast32_t i = 0; i < bytes / 4; i++)
+    {
+        w.append_int(static_cast<uint_fast32_t>(splitmix64(state)));
+    }
+    return d;
+}
+
+struct Generation
+{
+    Population pop;
+    Population next;
+    std::vector<uint_fast64_t> fitness;
+    std::vector<uint_fast32_t> parents;
+    uint_fast32_t bytes;
+};
+
+//Decodes a genome through Int32Dna and Long64Dna.
+uint_fast64_t decode(const Generation& g, uint_fast32_t i)
+{
+    uint_fast64_t score = 0;
+    Int32Dna w32(g.pop[i]);
+    Long64Dna w64(g.pop[i]);
+    for(uint_fast32_t k = 0; k < g.bytes / 4; k++)
+    {
+        score += __builtin_popcountll(w32.int_data(k));
+    }
+    return score + (w64.long_data(0) & 0xff);
+}
+
+//Stands in for a call to an external simulator.
+void simulate_fitness()
+{
+    if(g_fitness_us != 0)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(g_fitness_us));
+    }
+}
+
+void decode_and_score(Generation& g, uint_fast32_t begin, uint_fast32_t end)
+{
+    for(uint_fast32_t i = begin; i < end; i++)
+    {
+        uint_fast64_t score;
+        {
+            fn_PHASE_SCOPE(PHASE_DECODE);
+            score = decode(g, i);
+        }
+        fn_PHASE_SCOPE(PHASE_FITNESS);
+        simulate_fitness();
+        g.fitness[i] = score;
+    }
+}
+
+//Binary tournament among genomes [pool, pool + n): two parents per offspring.
+void tournament(Generation& g, uint_fast32_t begin, uint_fast32_t end, uint_fast64_t seed,
+    uint_fast32_t pool, uint_fast32_t n)
+{
+    fn_PHASE_SCOPE(PHASE_SELECTION);
+    uint_fast64_t state = seed;
+    for(uint_fast32_t i = begin; i < end; i++)
+    {
+        for(unsigned int p = 0; p < 2; p++)
+        {
+            uint_fast32_t a = pool + splitmix64(state) % n;
+            uint_fast32_t b = pool + splitmix64(state) % n;
+            g.parents[i * 2 + p] = g.fitness[a] >= g.fitness[b] ? a : b;
+        }
+    }
+}
+
+//One-point crossover followed by a single byte mutation.
+uint_fast64_t breed(Generation& g, uint_fast32_t begin, uint_fast32_t end, uint_fast64_t seed)
+{
+    uint_fast64_t state = seed;
+    uint_fast64_t allocated = 0;
+    for(uint_fast32_t i = begin; i < end; i++)
+    {
+        const CharDna& a = *g.pop[g.parents[i * 2]];
+        const CharDna& b = *g.pop[g.parents[i * 2 + 1]];
+        std::shared_ptr<CharDna> child = std::make_shared<CharDna>(splitmix64(state), g.bytes);
+        {
+            fn_PHASE_SCOPE(PHASE_CROSSOVER);
+            uint_fast32_t cut = splitmix64(state) % g.bytes;
+            for(uint_fast32_t k = 0; k < g.bytes; k++)
+            {
+                child->append_char(k < cut ? a.char_data(k) : b.char_data(k));
+            }
+        }
+        {
+            fn_PHASE_SCOPE(PHASE_MUTATION);
+            uint_fast64_t r = splitmix64(state);
+            uint_fast32_t pos = r % g.bytes;
+            child->set_char(pos, child->char_data(pos) ^ static_cast<char>(1 << ((r >> 32) & 7)));
+        }
+        allocated += child->capacity();
+        g.next[i] = std::move(child);
+    }
+    return allocated;
+}
+
+long read_status_kb(const char* key)
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    size_t len = strlen(key);
+    while(std::getline(status, line))
+    {
+        if(line.compare(0, len, key) == 0)
+        {
+            return std::stol(line.substr(len + 1));
+        }
+    }
+    return -1;
+}
+
+//Resets VmHWM to the current RSS (Linux 4.0+); silently ignored elsewhere.
+void reset_peak_rss()
+{
+    std::ofstream clear("/proc/self/clear_refs");
+    clear << "5";
+}
+
+//Stages for running generations as overlapping stages; selection is per
+//batch. The stages read the generation's seed from seed on every batch.
+//threads are split across the stages, mostly to fitness; every stage needs
+//one, so fewer than four still start four. started is the total.
+std::unique_ptr<GenerationPipeline> make_pipeline(Generation& g, unsigned int threads,
+    std::atomic<uint_fast64_t>& allocated, const uint_fast64_t& seed, unsigned int& started)
+{
+    PipelineStages stages;
+    stages.decode = [&g](GenomeBatch& b) {
+        for(uint_fast32_t k = 0; k < b.count; k++)
+        {
+            fn_PHASE_SCOPE(PHASE_DECODE);
+            b.fitness[k] = static_cast<double>(decode(g, b.first + k));
+        }
+    };
+    stages.fitness = [&g](GenomeBatch& b) {
+        for(uint_fast32_t k = 0; k < b.count; k++)
+        {
+            fn_PHASE_SCOPE(PHASE_FITNESS);
+            simulate_fitness();
+            g.fitness[b.first + k] = static_cast<uint_fast64_t>(b.fitness[k]);
+        }
+    };
+    stages.select = [&g, &seed](GenomeBatch& b) {
+        tournament(g, b.first, b.first + b.count, seed ^ b.first, b.first, b.count);
+    };
+    stages.breed = [&g, &allocated, &seed](GenomeBatch& b) {
+        allocated += breed(g, b.first, b.first + b.count, seed ^ (b.first + 0x5bd1e995));
+    };
+    stages.decode_threads = std::max(1u, threads / 8);
+    stages.select_threads = 1;
+    stages.breed_threads = std::max(1u, threads / 4);
+    unsigned int rest = stages.decode_threads + stages.select_threads + stages.breed_threads;
+    stages.fitness_threads = threads > rest ? threads - rest : 1;
+    started = rest + stages.fitness_threads;
+    return std::unique_ptr<GenerationPipeline>(new GenerationPipeline(stages, 256, 8));
+}
+
+void run(uint_fast32_t genomes, unsigned int threads, uint_fast32_t bytes, unsigned int gens)
+{
+    reset_peak_rss();
+    Generation g;
+    g.bytes = bytes;
+    g.pop.resize(genomes);
+    g.next.resize(genomes);
+    g.fitness.resize(genomes);
+    g.parents.resize(genomes * 2);
+    parallel_for(genomes, threads, [&g, bytes](uint_fast32_t begin, uint_fast32_t end, unsigned int) {
+        for(uint_fast32_t i = begin; i < end; i++)
+        {
+            g.pop[i] = random_genome(i + 1, bytes);
+        }
+    });
+
+    //Count only what the generations allocate.
+    DnaStats::reset();
+    std::vector<uint_fast64_t> allocated(threads, 0);
+    std::atomic<uint_fast64_t> pipeline_allocated(0);
+    uint_fast64_t pipeline_seed = 0;
+    std::unique_ptr<GenerationPipeline> pipeline;
+    unsigned int started = threads;
+    if(g_pipeline)
+    {
+        pipeline = make_pipeline(g, threads, pipeline_allocated, pipeline_seed, started);
+    }
+    typedef std::chrono::steady_clock clock;
+    clock::time_point t0 = clock::now();
+    for(unsigned int gen = 0; gen < gens; gen++)
+    {
+        if(g_pipeline)
+        {
+            pipeline_seed = static_cast<uint_fast64_t>(gen) << 32;
+            pipeline->run(g.pop.size());
+            g.pop.swap(g.next);
+            continue;
+        }
+        parallel_for(genomes, threads, [&g](uint_fast32_t begin, uint_fast32_t end, unsigned int) {
+            decode_and_score(g, begin, end);
+        });
+        parallel_for(genomes, threads, [&g, gen](uint_fast32_t begin, uint_fast32_t end, unsigned int t) {
+            tournament(g, begin, end, (static_cast<uint_fast64_t>(gen) << 32) ^ t, 0, static_cast<uint_fast32_t>(g.pop.size()));
+        });
+        parallel_for(genomes, threads, [&g, &allocated, gen](uint_fast32_t begin, uint_fast32_t end, unsigned int t) {
+            allocated[t] += breed(g, begin, end, (static_cast<uint_fast64_t>(gen) << 32) ^ (t + 0x5bd1e995));
+        });
+        g.pop.swap(g.next);
+    }
+    double secs = std::chrono::duration<double>(clock::now() - t0).count();
+    pipeline.reset();
+    allocated[0] += pipeline_allocated.load();
+
+    uint_fast64_t bytes_alloc = 0;
+    if(DnaStats::enabled)
+    {
+        bytes_alloc = DnaStats::snapshot().bytes_allocated;
+    } else
+    {
+        for(uint_fast64_t a : allocated)
+        {
+            bytes_alloc += a;
+        }
+    }
+    std::cout << genomes << ',' << started << ',' << bytes << ',' << gens << ','
+              << secs << ',' << (static_cast<double>(genomes) * gens / secs) << ','
+              << bytes_alloc << ',' << read_status_kb("VmHWM:") << ','
+              << (g_pipeline ? "pipeline" : "phased") << std::endl;
+}
+
+} //namespace
+
+int main(int argc, char** argv)
+{
+    uint_fast32_t min_genomes = 10000;
+    uint_fast32_t max_genomes = 1000000;
+    unsigned int max_threads = std::max(1u, std::thread::hardware_concurrency());
+    uint_fast32_t bytes = 64;
+    unsigned int gens = 3;
+    for(int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if(i + 1 >= argc)
+        {
+            std::cerr << "missing value for " << arg << std::endl;
+            return 2;
+        }
+        uint_fast64_t value = std::stoull(argv[++i]);
+        if(arg == "--min")
+        {
+            min_genomes = value;
+        } else if(arg == "--max")
+        {
+            max_genomes = value;
+        } else if(arg == "--threads")
+        {
+            max_threads = std::max<uint_fast64_t>(1, value);
+        } else if(arg == "--bytes")
+        {
+            bytes = std::max<uint_fast64_t>(8, value);
+        } else if(arg == "--gens")
+        {
+            gens = std::max<uint_fast64_t>(1, value);
+        } else if(arg == "--fitness-us")
+        {
+            g_fitness_us = value;
+        } else if(arg == "--pipeline")
+        {
+            g_pipeline = value != 0;
+        } else
+        {
+            std::cerr << "usage: " << argv[0]
+                      << " [--min N] [--max N] [--threads N] [--bytes B] [--gens G]"
+                      << " [--fitness-us U] [--pipeline 1]" << std::endl;
+            return 2;
+        }
+    }
+
+    std::cout << "genomes,threads,genome_bytes,generations,seconds,genomes_per_s,bytes_alloc,peak_rss_kb,mode" << std::endl;
+    for(uint_fast32_t genomes = min_genomes; genomes <= max_genomes; genomes *= 10)
+    {
+        for(unsigned int threads = 1; ; threads *= 2)
+        {
+            threads = std::min(threads, max_threads);
+            run(genomes, threads, bytes, gens);
+            if(threads == max_threads)
+            {
+                break;
+            }
+        }
+    }
+#ifdef fn_DNA_TIMING
+    PhaseTimings::report(std::cerr);
+#endif
+    return 0;
+}
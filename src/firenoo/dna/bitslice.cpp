@@ -0,0 +1,194 @@
+#include "bitslice.h"
+#include "phase_timing.h"
+#include "transpose.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+
+uint64_t splitmix64(uint64_t& state)
+{
+    uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Packs bit k of count (<= 64) bytes into one word per k: out[k] bit i is
+ * bit k of bytes[i].
+ */
+void pack_bits(const char* bytes, size_t count, uint64_t out[8])
+{
+    for(unsigned int k = 0; k < 8; k++)
+    {
+        out[k] = 0;
+    }
+    size_t i = 0;
+#if defined(__SSE2__)
+    //movemask gathers the top bit of 16 bytes; shift each bit into it.
+    for(; i + 16 <= count; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+        for(int k = 7; k >= 0; k--)
+        {
+            out[k] |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(v))) << i;
+            v = _mm_add_epi8(v, v);
+        }
+    }
+#endif
+    for(; i < count; i++)
+    {
+        unsigned char b = static_cast<unsigned char>(bytes[i]);
+        for(unsigned int k = 0; k < 8; k++)
+        {
+            out[k] |= static_cast<uint64_t>((b >> k) & 1) << i;
+        }
+    }
+}
+
+} //namespace
+
+BitSlicedPopulation::BitSlicedPopulation(uint_fast32_t bits, size_t individuals) :
+    m_bits(bits),
+    m_individuals(individuals),
+    m_stride(((individuals + 511) / 512) * 8)
+{
+    m_words.assign(static_cast<size_t>(bits) * m_stride, 0);
+}
+
+void BitSlicedPopulation::clear_padding()
+{
+    size_t full = m_individuals / 64;
+    uint64_t tail = m_individuals % 64 == 0 ? 0 : (1ull << (m_individuals % 64)) - 1;
+    for(uint_fast32_t j = 0; j < m_bits; j++)
+    {
+        uint64_t* p = plane(j);
+        size_t w = full;
+        if(tail != 0)
+        {
+            p[w++] &= tail;
+        }
+        for(; w < m_stride; w++)
+        {
+            p[w] = 0;
+        }
+    }
+}
+
+BitSlicedPopulation BitSlicedPopulation::from_genomes(const std::vector<const CharDna*>& genomes, uint_fast32_t bytes)
+{
+    BitSlicedPopulation out(bytes * 8, genomes.size());
+    //Locus-major bytes make each group of 64 individuals contiguous.
+    LocusColumns<char> cols = transpose_chars(genomes, bytes);
+    uint64_t packed[8];
+    for(uint_fast32_t b = 0; b < bytes; b++)
+    {
+        const char* col = cols.column(b);
+        for(size_t i = 0; i < genomes.size(); i += 64)
+        {
+            size_t count = genomes.size() - i < 64 ? genomes.size() - i : 64;
+            pack_bits(col + i, count, packed);
+            for(unsigned int k = 0; k < 8; k++)
+            {
+                out.plane(b * 8 + k)[i / 64] = packed[k];
+            }
+        }
+    }
+    return out;
+}
+
+CharDna BitSlicedPopulation::to_genome(size_t individual, uint_fast64_t seed) const
+{
+    uint_fast32_t bytes = m_bits / 8;
+    CharDna out(seed, bytes);
+    size_t w = individual / 64;
+    unsigned int s = individual % 64;
+    for(uint_fast32_t b = 0; b < bytes; b++)
+    {
+        unsigned int v = 0;
+        for(unsigned int k = 0; k < 8; k++)
+        {
+            v |= static_cast<unsigned int>((plane(b * 8 + k)[w] >> s) & 1) << k;
+        }
+        out.append_char(static_cast<char>(v));
+    }
+    return out;
+}
+
+void BitSlicedPopulation::apply_mask(const BitSlicedPopulation& mask)
+{
+    fn_PHASE_SCOPE(PHASE_MUTATION);
+    uint64_t* dst = m_words.data();
+    const uint64_t* src = mask.m_words.data();
+    size_t n = m_words.size() < mask.m_words.size() ? m_words.size() : mask.m_words.size();
+    for(size_t i = 0; i < n; i++)
+    {
+        dst[i] ^= src[i];
+    }
+    clear_padding();
+}
+
+void BitSlicedPopulation::mutate(unsigned int rate_log2, uint_fast64_t seed)
+{
+    fn_PHASE_SCOPE(PHASE_MUTATION);
+    uint64_t state = seed;
+    for(size_t i = 0; i < m_words.size(); i++)
+    {
+        uint64_t m = ~0ull;
+        for(unsigned int r = 0; r < rate_log2; r++)
+        {
+            m &= splitmix64(state);
+        }
+        m_words[i] ^= m;
+    }
+    clear_padding();
+}
+
+void BitSlicedPopulation::uniform_crossover(const BitSlicedPopulation& a, const BitSlicedPopulation& b,
+    const BitSlicedPopulation& mask)
+{
+    fn_PHASE_SCOPE(PHASE_CROSSOVER);
+    uint64_t* dst = m_words.data();
+    const uint64_t* pa = a.m_words.data();
+    const uint64_t* pb = b.m_words.data();
+    const uint64_t* pm = mask.m_words.data();
+    size_t n = m_words.size();
+    for(size_t i = 0; i < n; i++)
+    {
+        dst[i] = (pa[i] & pm[i]) | (pb[i] & ~pm[i]);
+    }
+}
+
+void BitSlicedPopulation::uniform_crossover(const BitSlicedPopulation& a, const BitSlicedPopulation& b,
+    uint_fast64_t seed)
+{
+    fn_PHASE_SCOPE(PHASE_CROSSOVER);
+    uint64_t state = seed;
+    const uint64_t* pa = a.m_words.data();
+    const uint64_t* pb = b.m_words.data();
+    for(size_t i = 0; i < m_words.size(); i++)
+    {
+        uint64_t m = splitmix64(state);
+        m_words[i] = (pa[i] & m) | (pb[i] & ~m);
+    }
+}
+
+std::vector<uint_fast64_t> BitSlicedPopulation::allele_counts() const
+{
+    std::vector<uint_fast64_t> counts(m_bits, 0);
+    for(uint_fast32_t j = 0; j < m_bits; j++)
+    {
+        const uint64_t* p = plane(j);
+        uint_fast64_t c = 0;
+        for(size_t w = 0; w < m_stride; w++)
+        {
+            c += __builtin_popcountll(p[w]);
+        }
+        counts[j] = c;
+    }
+    return counts;
+}
@@ -0,0 +1,109 @@
+#ifndef fn_BITSLICE_H
+#define fn_BITSLICE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#include "char_dna.h"
+
+/**
+ * Bit-sliced population: plane j packs bit j of every individual into 64-bit
+ * words, individual i at bit i % 64 of word i / 64. Genome bit j is bit j % 8
+ * of byte j / 8.
+ *
+ * Mutation masks, uniform crossover and allele counting become plain word
+ * loops over planes, 64 individuals per operation. Planes are padded to a
+ * multiple of 512 bits so the compiler can widen those loops to AVX2/AVX-512.
+ * Padding bits are kept zero.
+ */
+class BitSlicedPopulation
+{
+private:
+    std::vector<uint64_t> m_words;
+    uint_fast32_t m_bits;
+    size_t m_individuals;
+    size_t m_stride;
+
+    void clear_padding();
+
+public:
+    BitSlicedPopulation(uint_fast32_t bits, size_t individuals);
+
+    /**
+     * Slices the first bytes of every genome; bytes past a genome's length
+     * read as 0.
+     */
+    static BitSlicedPopulation from_genomes(const std::vector<const CharDna*>& genomes, uint_fast32_t bytes);
+
+    //Rebuilds one individual as a CharDna of bits / 8 bytes.
+    CharDna to_genome(size_t individual, uint_fast64_t seed) const;
+
+    uint64_t* plane(uint_fast32_t bit)
+    {
+        return m_words.data() + bit * m_stride;
+    }
+
+    const uint64_t* plane(uint_fast32_t bit) const
+    {
+        return m_words.data() + bit * m_stride;
+    }
+
+    bool get(uint_fast32_t bit, size_t individual) const
+    {
+        return (plane(bit)[individual / 64] >> (individual % 64)) & 1;
+    }
+
+    void set(uint_fast32_t bit, size_t individual, bool value)
+    {
+        uint64_t m = 1ull << (individual % 64);
+        uint64_t& w = plane(bit)[individual / 64];
+        w = value ? (w | m) : (w & ~m);
+    }
+
+    uint_fast32_t bits() const
+    {
+        return m_bits;
+    }
+
+    size_t individuals() const
+    {
+        return m_individuals;
+    }
+
+    //Words per plane, including padding.
+    size_t stride() const
+    {
+        return m_stride;
+    }
+
+    /**
+     * Flips every bit set in mask, which must have the same shape.
+     */
+    void apply_mask(const BitSlicedPopulation& mask);
+
+    /**
+     * Flips each bit with probability 2^-rate_log2 by ANDing rate_log2
+     * random words per mask word.
+     */
+    void mutate(unsigned int rate_log2, uint_fast64_t seed);
+
+    /**
+     * Uniform crossover of individual i of a with individual i of b: each bit
+     * comes from a where mask is set, else from b. All three must have the
+     * same shape as this, which receives the children. This may be a, b or
+     * mask; each word is read before it is written.
+     */
+    void uniform_crossover(const BitSlicedPopulation& a, const BitSlicedPopulation& b,
+        const BitSlicedPopulation& mask);
+
+    //Same, with a random mask drawn from seed.
+    void uniform_crossover(const BitSlicedPopulation& a, const BitSlicedPopulation& b, uint_fast64_t seed);
+
+    /**
+     * Number of individuals with each bit set; element j is for bit j.
+     */
+    std::vector<uint_fast64_t> allele_counts() const;
+};
+
+#endif
@@ -0,0 +1,228 @@
+#ifndef fn_BOUNDED_QUEUE_H
+#define fn_BOUNDED_QUEUE_H
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/**
+ * Bounded lock-free multi-producer/multi-consumer queue (Vyukov's array
+ * queue). Capacity is rounded up to a power of two. Each cell carries a
+ * sequence number telling producers and consumers whose turn it is, so push
+ * and pop are one CAS on the shared position in the common case.
+ *
+ * The blocking push() and pop() spin briefly, then park on a condition
+ * variable, and only take the lock to wake a thread that is parked. An idle
+ * consumer therefore sleeps instead of burning a core. try_push() and
+ * try_pop() never park or wake anyone, so a queue with parked threads must
+ * be fed through push() and pop().
+ *
+ * close() lets consumers drain what is left and then see pop() fail.
+ */
+template<typename T>
+class BoundedQueue
+{
+private:
+    struct Cell
+    {
+        std::atomic<uint_fast64_t> seq;
+        T value;
+    };
+
+    //Attempts before a blocking call parks.
+    static const unsigned int kSpins = 64;
+
+    std::unique_ptr<Cell[]> m_cells;
+    uint_fast64_t m_mask;
+    alignas(64) std::atomic<uint_fast64_t> m_head;
+    alignas(64) std::atomic<uint_fast64_t> m_tail;
+    alignas(64) std::atomic<bool> m_closed;
+    std::atomic<unsigned int> m_pop_waiters;
+    std::atomic<unsigned int> m_push_waiters;
+    std::mutex m_park;
+    std::condition_variable m_not_empty;
+    std::condition_variable m_not_full;
+
+    //Wakes a parked thread, if any. The fence pairs with the one in park().
+    void wake(std::atomic<unsigned int>& waiters, std::condition_variable& cv)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(waiters.load(std::memory_order_relaxed) > 0)
+        {
+            std::lock_guard<std::mutex> lock(m_park);
+            cv.notify_one();
+        }
+    }
+
+    //Waits on cv until attempt() succeeds or done() holds; returns whether attempt() succeeded.
+    template<typename Attempt, typename Done>
+    bool park(std::atomic<unsigned int>& waiters, std::condition_variable& cv, Attempt attempt, Done done)
+    {
+        std::unique_lock<std::mutex> lock(m_park);
+        waiters.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool ok;
+        for(;;)
+        {
+            if(attempt())
+            {
+                ok = true;
+                break;
+            }
+            if(done())
+            {
+                ok = false;
+                break;
+            }
+            cv.wait(lock);
+        }
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+        return ok;
+    }
+
+public:
+    explicit BoundedQueue(uint_fast64_t capacity) :
+        m_head(0),
+        m_tail(0),
+        m_closed(false),
+        m_pop_waiters(0),
+        m_push_waiters(0)
+    {
+        uint_fast64_t size = 2;
+        while(size < capacity)
+        {
+            size <<= 1;
+        }
+        m_cells.reset(new Cell[size]);
+        m_mask = size - 1;
+        for(uint_fast64_t i = 0; i < size; i++)
+        {
+            m_cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    //Returns false if the queue is full.
+    bool try_push(const T& value)
+    {
+        uint_fast64_t pos = m_tail.load(std::memory_order_relaxed);
+        for(;;)
+        {
+            Cell& cell = m_cells[pos & m_mask];
+            uint_fast64_t seq = cell.seq.load(std::memory_order_acquire);
+            int_fast64_t diff = static_cast<int_fast64_t>(seq) - static_cast<int_fast64_t>(pos);
+            if(diff == 0)
+            {
+                if(m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    cell.value = value;
+                    cell.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if(diff < 0)
+            {
+                return false;
+            } else
+            {
+                pos = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    //Returns false if the queue is empty.
+    bool try_pop(T& out)
+    {
+        uint_fast64_t pos = m_head.load(std::memory_order_relaxed);
+        for(;;)
+        {
+            Cell& cell = m_cells[pos & m_mask];
+            uint_fast64_t seq = cell.seq.load(std::memory_order_acquire);
+            int_fast64_t diff = static_cast<int_fast64_t>(seq) - static_cast<int_fast64_t>(pos + 1);
+            if(diff == 0)
+            {
+                if(m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    out = cell.value;
+                    cell.seq.store(pos + m_mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if(diff < 0)
+            {
+                return false;
+            } else
+            {
+                pos = m_head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    //Waits until there is room.
+    void push(const T& value)
+    {
+        bool pushed = false;
+        for(unsigned int i = 0; i < kSpins && !pushed; i++)
+        {
+            pushed = try_push(value);
+            if(!pushed)
+            {
+                std::this_thread::yield();
+            }
+        }
+        if(!pushed)
+        {
+            park(m_push_waiters, m_not_full, [&]() { return try_push(value); }, []() { return false; });
+        }
+        wake(m_pop_waiters, m_not_empty);
+    }
+
+    /**
+     * Waits for a value. Returns false once the queue is closed and empty.
+     */
+    bool pop(T& out)
+    {
+        bool popped = false;
+        for(unsigned int i = 0; i < kSpins && !popped; i++)
+        {
+            popped = try_pop(out);
+            if(!popped)
+            {
+                if(m_closed.load(std::memory_order_acquire))
+                {
+                    //Pick up anything pushed just before close().
+                    popped = try_pop(out);
+                    break;
+                }
+                std::this_thread::yield();
+            }
+        }
+        if(!popped && !m_closed.load(std::memory_order_acquire))
+        {
+            popped = park(m_pop_waiters, m_not_empty, [&]() { return try_pop(out); },
+                [this]() { return m_closed.load(std::memory_order_acquire); });
+            if(!popped)
+            {
+                popped = try_pop(out);
+            }
+        }
+        if(popped)
+        {
+            wake(m_push_waiters, m_not_full);
+        }
+        return popped;
+    }
+
+    //No more pushes will follow. Wakes every parked consumer.
+    void close()
+    {
+        m_closed.store(true, std::memory_order_release);
+        std::lock_guard<std::mutex> lock(m_park);
+        m_not_empty.notify_all();
+    }
+};
+
+#endif
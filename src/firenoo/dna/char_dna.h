@@ -0,0 +1,260 @@
+#ifndef fn_CHAR_DNA_H
+#define fn_CHAR_DNA_H
+
+#include <string.h>
+#include <stdint.h>
+
+#include <new>
+
+#include "defs.h"
+#include "dna_probes.h"
+#include "dna_stats.h"
+
+/**
+ * Base character class for holding DNA data. Contains methods for manipulating
+ * single bytes of data (8-bits, char).
+ *
+ * Capacity is allocated in whole units of UnitSize bytes. Power of two units
+ * wider than the default new alignment (e.g. 64 for cache lines) also align
+ * the buffer to a unit boundary, so SIMD kernels can use aligned loads.
+ */
+
+template<uint_fast32_t UnitSize>
+class BasicCharDna
+{
+    static_assert(UnitSize > 0, "unit size must be non-zero");
+
+private:
+    char* m_data;
+    uint_fast32_t m_len;
+    uint_fast64_t m_seed;
+    uint_fast32_t m_ptr;
+
+    static constexpr bool kAligned = (UnitSize & (UnitSize - 1)) == 0
+        && UnitSize > __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+    static char* allocate(uint_fast32_t len)
+    {
+        if constexpr(kAligned)
+        {
+            return static_cast<char*>(::operator new[](len, std::align_val_t(UnitSize)));
+        }
+        else
+        {
+            return new char[len];
+        }
+    }
+
+    static void release(char* data)
+    {
+        if constexpr(kAligned)
+        {
+            ::operator delete[](data, std::align_val_t(UnitSize));
+        }
+        else
+        {
+            delete[] data;
+        }
+    }
+
+protected:
+    void realloc(uint_fast32_t newLen)
+    {
+        newLen = round_up(newLen);
+        if(newLen < m_ptr)
+        {
+            //ERROR - just do nothing
+            return;
+        }
+        fn_PROBE3(realloc, m_len, newLen, m_ptr);
+        char* newBuf = allocate(newLen);
+        //Copy whole units; m_len is a multiple of the unit so this stays in bounds.
+        uint_fast32_t used = round_up(m_ptr);
+        if(used > 0)
+        {
+            memcpy(newBuf, m_data, used);
+        }
+        memset(newBuf + used, 0, newLen - used);
+        DnaStats::on_realloc(m_len, newLen, m_ptr);
+        m_len = newLen;
+        release(m_data);
+        m_data = newBuf;
+    }
+
+public:
+    static constexpr uint_fast32_t unit_size = UnitSize;
+
+    //Rounds a byte count up to whole units.
+    static constexpr uint_fast32_t round_up(uint_fast32_t len)
+    {
+        return (len + UnitSize - 1) / UnitSize * UnitSize;
+    }
+
+    BasicCharDna(uint_fast64_t seed, uint_fast32_t init_len) :
+        m_data(allocate(round_up(init_len))),
+        m_len(round_up(init_len)),
+        m_seed(seed),
+        m_ptr(0)
+    {
+        memset(m_data, 0, m_len);
+        DnaStats::on_alloc(m_len);
+    }
+
+    BasicCharDna(uint_fast64_t seed, uint_fast32_t init_len, const char* src) :
+        m_data(allocate(round_up(init_len))),
+        m_len(round_up(init_len)),
+        m_seed(seed),
+        m_ptr(init_len)
+    {
+        memcpy(m_data, src, init_len);
+        memset(m_data + init_len, 0, m_len - init_len);
+        DnaStats::on_alloc(m_len);
+        DnaStats::on_copy(init_len);
+        DnaStats::on_grow(init_len);
+    }
+
+    BasicCharDna(const BasicCharDna& other) :
+        m_data(allocate(other.m_len)),
+        m_len(other.m_len),
+        m_seed(other.m_seed),
+        m_ptr(other.m_ptr)
+    {
+        memcpy(m_data, other.m_data, m_len);
+        DnaStats::on_alloc(m_len);
+        DnaStats::on_copy(m_len);
+        DnaStats::on_copy_construct();
+        DnaStats::on_grow(m_ptr);
+    }
+
+    BasicCharDna(BasicCharDna&& other) noexcept :
+        m_data(other.m_data),
+        m_len(other.m_len),
+        m_seed(other.m_seed),
+        m_ptr(other.m_ptr)
+    {
+        other.m_data = nullptr;
+        other.m_len = 0;
+        other.m_ptr = 0;
+    }
+
+    BasicCharDna& operator=(BasicCharDna&& other) noexcept
+    {
+        if(this != &other)
+        {
+            DnaStats::on_free(m_len, m_ptr);
+            release(m_data);
+            m_data = other.m_data;
+            m_len = other.m_len;
+            m_seed = other.m_seed;
+            m_ptr = other.m_ptr;
+            other.m_data = nullptr;
+            other.m_len = 0;
+            other.m_ptr = 0;
+        }
+        return *this;
+    }
+    
+    ~BasicCharDna()
+    {
+        DnaStats::on_free(m_len, m_ptr);
+        release(m_data);
+    }
+
+    char operator[](uint_fast32_t offset)
+    {
+        return *(m_data + offset);
+    }
+
+    /**
+     * Sets the data at the offset to the specified char, allocating new space
+     * as necessary. The offset is measured in 8-bit units.
+     */
+    void set_char(uint_fast32_t offset, char newData)
+    {
+        if(offset >= m_len)
+        {
+            realloc((offset + 1) * 2);
+        }
+        if(offset >= m_ptr)
+        {
+            DnaStats::on_grow(offset + 1 - m_ptr);
+            m_ptr = offset + 1;
+        }
+        *(m_data + offset) = newData;
+    }
+
+    /**
+     * Adds the specified char to the end of the data array, allocating new
+     * space as necessary.
+     */
+    void append_char(char newData)
+    {
+        set_char(m_ptr, newData);
+    }
+
+    /**
+     * Sets the length to newLen, allocating new space as necessary, and
+     * returns the data array so bulk writers can fill it in place. Bytes
+     * added by growing read as 0.
+     */
+    char* resize(uint_fast32_t newLen)
+    {
+        if(newLen > m_len)
+        {
+            realloc(newLen);
+        }
+        if(newLen > m_ptr)
+        {
+            DnaStats::on_grow(newLen - m_ptr);
+        } else
+        {
+            //Keep bytes past the length zeroed for later growth.
+            memset(m_data + newLen, 0, m_ptr - newLen);
+            DnaStats::on_shrink(m_ptr - newLen);
+        }
+        m_ptr = newLen;
+        return m_data;
+    }
+
+    char char_data(uint_fast32_t offset) const
+    {
+        return *(m_data + offset);
+    }
+
+    uint_fast32_t capacity() const
+    {
+        return m_len;
+    }
+
+    uint_fast32_t len() const
+    {
+        return m_ptr;
+    }
+
+    /**
+     * Copies the data of a genome with a different unit size. Only the
+     * capacity changes; the bytes and seed carry over unchanged.
+     */
+    template<uint_fast32_t OtherSize>
+    static BasicCharDna convert(const BasicCharDna<OtherSize>& other)
+    {
+        return BasicCharDna(other.seed(), other.len(), other.all_data());
+    }
+
+    const char* all_data() const
+    {
+        return const_cast<const char*>(m_data);
+    }
+
+    uint_fast64_t seed() const
+    {
+        return m_seed;
+    }
+};
+
+typedef BasicCharDna<fn_UNIT_SIZE> CharDna;
+
+//Cache line sized units for the SIMD kernels.
+typedef BasicCharDna<64> LineDna;
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef fn_DEFS_H
+#define fn_DEFS_H
+
+#define fn_UNIT_SIZE 16 //unit size, in bytes (8-bit units)
+#define fn_TYPEDDNA_ID 1
+
+#define fn_BYTE 1
+#define fn_SHORT 2
+#define fn_INT 4
+#define fn_LONG 8
+
+#endif
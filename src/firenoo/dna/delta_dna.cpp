@@ -0,0 +1,170 @@
+#include <string.h>
+#include <algorithm>
+
+#include "delta_dna.h"
+#include "phase_timing.h"
+
+DeltaDna::DeltaDna(uint_fast64_t seed, uint_fast32_t len) :
+    m_seed(seed),
+    m_len(len),
+    m_depth(0)
+{
+}
+
+DeltaDna::Ptr DeltaDna::from_genome(const CharDna& genome)
+{
+    return from_genome(CharDna(genome));
+}
+
+DeltaDna::Ptr DeltaDna::from_genome(CharDna&& genome)
+{
+    DeltaDna* node = new DeltaDna(genome.seed(), genome.len());
+    node->m_base.reset(new CharDna(std::move(genome)));
+    return Ptr(node);
+}
+
+DeltaDna::Ptr DeltaDna::offspring(uint_fast64_t seed, uint_fast32_t len, const Ptr& a, const Ptr& b,
+    const std::vector<uint_fast32_t>& points, const std::vector<DnaPatch>& patches,
+    unsigned int max_depth)
+{
+    fn_PHASE_SCOPE(PHASE_CROSSOVER);
+    std::shared_ptr<DeltaDna> node(new DeltaDna(seed, len));
+    node->m_a = a;
+    node->m_b = b;
+    if(b != nullptr)
+    {
+        node->m_points = points;
+    }
+    size_t total = 0;
+    for(const DnaPatch& p : patches)
+    {
+        total += p.bytes.size();
+    }
+    node->m_bytes.reserve(total);
+    node->m_ranges.reserve(patches.size());
+    for(const DnaPatch& p : patches)
+    {
+        if(p.bytes.empty() || p.offset >= len)
+        {
+            continue;
+        }
+        Range r;
+        r.offset = p.offset;
+        r.len = static_cast<uint_fast32_t>(std::min<size_t>(p.bytes.size(), len - p.offset));
+        r.pos = node->m_bytes.size();
+        node->m_bytes.insert(node->m_bytes.end(), p.bytes.begin(), p.bytes.begin() + r.len);
+        node->m_ranges.push_back(r);
+    }
+    unsigned int da = a != nullptr ? a->m_depth : 0;
+    unsigned int db = b != nullptr ? b->m_depth : 0;
+    node->m_depth = std::max(da, db) + 1;
+    if(node->m_depth > max_depth)
+    {
+        //Flatten; the parents are released with the patch.
+        return from_genome(node->materialize());
+    }
+    return node;
+}
+
+const DeltaDna* DeltaDna::source(uint_fast32_t offset) const
+{
+    if(m_b == nullptr)
+    {
+        return m_a.get();
+    }
+    size_t switches = std::upper_bound(m_points.begin(), m_points.end(), offset) - m_points.begin();
+    return switches % 2 == 0 ? m_a.get() : m_b.get();
+}
+
+char DeltaDna::char_data(uint_fast32_t offset) const
+{
+    if(offset >= m_len)
+    {
+        return 0;
+    }
+    if(m_base != nullptr)
+    {
+        return m_base->char_data(offset);
+    }
+    for(size_t i = m_ranges.size(); i > 0; i--)
+    {
+        const Range& r = m_ranges[i - 1];
+        if(offset >= r.offset && offset - r.offset < r.len)
+        {
+            return m_bytes[r.pos + (offset - r.offset)];
+        }
+    }
+    const DeltaDna* parent = source(offset);
+    return parent != nullptr ? parent->char_data(offset) : 0;
+}
+
+void DeltaDna::fill(char* out, uint_fast32_t begin, uint_fast32_t end) const
+{
+    uint_fast32_t stop = std::min(end, m_len);
+    if(stop < end)
+    {
+        memset(out + (stop > begin ? stop - begin : 0), 0, end - std::max(stop, begin));
+    }
+    if(begin >= stop)
+    {
+        return;
+    }
+    if(m_base != nullptr)
+    {
+        memcpy(out, m_base->all_data() + begin, stop - begin);
+        return;
+    }
+    //Copy each crossover segment from its parent.
+    uint_fast32_t at = begin;
+    while(at < stop)
+    {
+        uint_fast32_t next = stop;
+        if(m_b != nullptr)
+        {
+            std::vector<uint_fast32_t>::const_iterator it = std::upper_bound(m_points.begin(), m_points.end(), at);
+            if(it != m_points.end() && *it < stop)
+            {
+                next = *it;
+            }
+        }
+        const DeltaDna* parent = source(at);
+        if(parent != nullptr)
+        {
+            parent->fill(out + (at - begin), at, next);
+        } else
+        {
+            memset(out + (at - begin), 0, next - at);
+        }
+        at = next;
+    }
+    for(const Range& r : m_ranges)
+    {
+        uint_fast32_t lo = std::max(r.offset, begin);
+        uint_fast32_t hi = std::min(r.offset + r.len, stop);
+        if(lo < hi)
+        {
+            memcpy(out + (lo - begin), m_bytes.data() + r.pos + (lo - r.offset), hi - lo);
+        }
+    }
+}
+
+CharDna DeltaDna::materialize() const
+{
+    if(m_base != nullptr)
+    {
+        return CharDna(*m_base);
+    }
+    std::unique_ptr<char[]> buf(new char[m_len]);
+    fill(buf.get(), 0, m_len);
+    return CharDna(m_seed, m_len, buf.get());
+}
+
+size_t DeltaDna::footprint() const
+{
+    if(m_base != nullptr)
+    {
+        return sizeof(*this) + m_base->capacity();
+    }
+    return sizeof(*this) + m_points.capacity() * sizeof(uint_fast32_t) + m_ranges.capacity() * sizeof(Range)
+        + m_bytes.capacity();
+}
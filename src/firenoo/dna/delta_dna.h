@@ -0,0 +1,121 @@
+#ifndef fn_DELTA_DNA_H
+#define fn_DELTA_DNA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <memory>
+#include <vector>
+
+#include "char_dna.h"
+
+/**
+ * Bytes to overwrite in an offspring, starting at offset.
+ */
+struct DnaPatch
+{
+    uint_fast32_t offset;
+    std::vector<char> bytes;
+};
+
+/**
+ * Genome stored as a patch against one or two parents instead of a full copy.
+ *
+ * Byte i of an offspring comes from parent a, or from parent b when an odd
+ * number of crossover points are <= i. Patches are then applied on top, the
+ * later one winning where they overlap. Bytes past a parent's length read as
+ * 0. A base node simply owns a CharDna.
+ *
+ * Nodes are immutable once built and shared through Ptr, so any number of
+ * threads may read them. Reading a byte walks the chain; materialize()
+ * builds a full CharDna in one pass. When an offspring would be deeper than
+ * max_depth it is materialized into a base node straight away, which bounds
+ * the cost of every read.
+ */
+class DeltaDna
+{
+public:
+    typedef std::shared_ptr<const DeltaDna> Ptr;
+
+    static const unsigned int kMaxDepth = 8;
+
+private:
+    struct Range
+    {
+        uint_fast32_t offset;
+        uint_fast32_t len;
+        //Start of the bytes in m_bytes.
+        size_t pos;
+    };
+
+    std::unique_ptr<const CharDna> m_base;
+    Ptr m_a;
+    Ptr m_b;
+    std::vector<uint_fast32_t> m_points;
+    std::vector<Range> m_ranges;
+    std::vector<char> m_bytes;
+    uint_fast64_t m_seed;
+    uint_fast32_t m_len;
+    unsigned int m_depth;
+
+    DeltaDna(uint_fast64_t seed, uint_fast32_t len);
+
+    //Parent that byte offset is inherited from.
+    const DeltaDna* source(uint_fast32_t offset) const;
+
+    //Writes bytes [begin, end) into out, which holds byte begin at out[0].
+    void fill(char* out, uint_fast32_t begin, uint_fast32_t end) const;
+
+public:
+    /**
+     * Base node holding a copy of genome.
+     */
+    static Ptr from_genome(const CharDna& genome);
+
+    /**
+     * Base node that takes over genome's buffer.
+     */
+    static Ptr from_genome(CharDna&& genome);
+
+    /**
+     * Offspring of a and b, which may be null for a mutation-only child of a.
+     * points must be sorted ascending.
+     */
+    static Ptr offspring(uint_fast64_t seed, uint_fast32_t len, const Ptr& a, const Ptr& b,
+        const std::vector<uint_fast32_t>& points, const std::vector<DnaPatch>& patches,
+        unsigned int max_depth = kMaxDepth);
+
+    char char_data(uint_fast32_t offset) const;
+
+    /**
+     * Full copy of the genome.
+     */
+    CharDna materialize() const;
+
+    uint_fast32_t len() const
+    {
+        return m_len;
+    }
+
+    uint_fast64_t seed() const
+    {
+        return m_seed;
+    }
+
+    //0 for a base node, else one more than the deeper parent.
+    unsigned int depth() const
+    {
+        return m_depth;
+    }
+
+    bool is_base() const
+    {
+        return m_base != nullptr;
+    }
+
+    /**
+     * Bytes owned by this node alone, not counting parents.
+     */
+    size_t footprint() const;
+};
+
+#endif
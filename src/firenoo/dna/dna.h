@@ -0,0 +1,36 @@
+#ifndef fn_DNA_H
+#define fn_DNA_H
+
+//This file provides the classes for manipulating data on DNA, according to my
+//typed data format. Meant to be used in 8-bit byte machines.
+//Hot accessors are defined inline in the headers; serialization is compiled
+//in dna.cpp.
+
+#include "defs.h"
+#include "dna_stats.h"
+#include "phase_timing.h"
+#include "char_dna.h"
+#include "typed_dna.h"
+#include "gene.h"
+#include "ribosome.h"
+#include "pipeline.h"
+#include "fitness_cache.h"
+#include "batch_fitness.h"
+#include "population.h"
+#include "numa.h"
+#include "seqlock_dna.h"
+#include "serialize.h"
+#include "population_image.h"
+#include "transpose.h"
+#include "bitslice.h"
+#include "allele_stats.h"
+#include "ranking.h"
+#include "delta_dna.h"
+#include "dna_hash.h"
+#include "genome_store.h"
+#include "lineage.h"
+#include "genome_init.h"
+#include "rope_dna.h"
+#include "sparse_dna.h"
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef fn_DNA_HASH_H
+#define fn_DNA_HASH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * 128-bit content hash of a genome payload.
+ */
+struct DnaHash128
+{
+    uint64_t lo;
+    uint64_t hi;
+
+    bool operator==(const DnaHash128& other) const
+    {
+        return lo == other.lo && hi == other.hi;
+    }
+
+    bool operator!=(const DnaHash128& other) const
+    {
+        return !(*this == other);
+    }
+};
+
+namespace dna_hash_detail
+{
+
+inline uint64_t rotl(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t fmix(uint64_t k)
+{
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdull;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ull;
+    k ^= k >> 33;
+    return k;
+}
+
+inline uint64_t load64(const char* p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+} //namespace dna_hash_detail
+
+/**
+ * MurmurHash3 x64_128 of len bytes, reading input as little endian so hashes
+ * match across hosts. seed mixes into both lanes.
+ */
+inline DnaHash128 hash_bytes(const char* data, size_t len, uint64_t seed = 0)
+{
+    using namespace dna_hash_detail;
+    const uint64_t c1 = 0x87c37b91114253d5ull;
+    const uint64_t c2 = 0x4cf5ad432745937full;
+    uint64_t h1 = seed;
+    uint64_t h2 = seed;
+    size_t blocks = len / 16;
+    for(size_t i = 0; i < blocks; i++)
+    {
+        uint64_t k1 = load64(data + i * 16);
+        uint64_t k2 = load64(data + i * 16 + 8);
+        k1 *= c1;
+        k1 = rotl(k1, 31);
+        k1 *= c2;
+        h1 ^= k1;
+        h1 = rotl(h1, 27);
+        h1 += h2;
+        h1 = h1 * 5 + 0x52dce729;
+        k2 *= c2;
+        k2 = rotl(k2, 33);
+        k2 *= c1;
+        h2 ^= k2;
+        h2 = rotl(h2, 31);
+        h2 += h1;
+        h2 = h2 * 5 + 0x38495ab5;
+    }
+    const unsigned char* tail = reinterpret_cast<const unsigned char*>(data + blocks * 16);
+    uint64_t k1 = 0;
+    uint64_t k2 = 0;
+    size_t rest = len & 15;
+    for(size_t i = rest; i > 8; i--)
+    {
+        k2 ^= static_cast<uint64_t>(tail[i - 1]) << ((i - 9) * 8);
+    }
+    if(rest > 8)
+    {
+        k2 *= c2;
+        k2 = rotl(k2, 33);
+        k2 *= c1;
+        h2 ^= k2;
+    }
+    for(size_t i = rest < 8 ? rest : 8; i > 0; i--)
+    {
+        k1 ^= static_cast<uint64_t>(tail[i - 1]) << ((i - 1) * 8);
+    }
+    if(rest > 0)
+    {
+        k1 *= c1;
+        k1 = rotl(k1, 31);
+        k1 *= c2;
+        h1 ^= k1;
+    }
+    h1 ^= len;
+    h2 ^= len;
+    h1 += h2;
+    h2 += h1;
+    h1 = fmix(h1);
+    h2 = fmix(h2);
+    h1 += h2;
+    h2 += h1;
+    DnaHash128 out;
+    out.lo = h1;
+    out.hi = h2;
+    return out;
+}
+
+#endif
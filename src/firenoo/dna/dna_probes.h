@@ -0,0 +1,29 @@
+#ifndef fn_DNA_PROBES_H
+#define fn_DNA_PROBES_H
+
+//Static USDT tracepoints (provider "typeddna") on the DNA hot paths. Define
+//fn_DNA_PROBES to emit them; this needs <sys/sdt.h> from systemtap-sdt-dev.
+//Without the flag every probe compiles to nothing. A disabled probe that is
+//compiled in costs a single nop until perf or bpftrace attaches to it, e.g.
+//
+//  bpftrace -e 'usdt:./app:typeddna:realloc { @[arg1] = count(); }'
+//
+//Probes:
+//  realloc(old_capacity, new_capacity, len)          CharDna::realloc
+//  serialize_record_start(index, len, seed)          before a record is written
+//  serialize_record_done(index, len)                 after a record is written
+//  deserialize_record_start(index)                   before a record is read
+//  deserialize_record_done(index, len, seed)         after a record is read
+
+#ifdef fn_DNA_PROBES
+#include <sys/sdt.h>
+#define fn_PROBE1(name, a) DTRACE_PROBE1(typeddna, name, a)
+#define fn_PROBE2(name, a, b) DTRACE_PROBE2(typeddna, name, a, b)
+#define fn_PROBE3(name, a, b, c) DTRACE_PROBE3(typeddna, name, a, b, c)
+#else
+#define fn_PROBE1(name, a)
+#define fn_PROBE2(name, a, b)
+#define fn_PROBE3(name, a, b, c)
+#endif
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef fn_DNA_STATS_H
+#define fn_DNA_STATS_H
+
+#include <stdint.h>
+
+#ifdef fn_DNA_STATS
+#include <atomic>
+#endif
+
+//Allocation and copy counters for CharDna storage. Define fn_DNA_STATS to
+//enable them; otherwise every hook is an empty inline function and
+//DnaStats::snapshot() returns zeros.
+
+/**
+ * Point-in-time copy of the process-wide CharDna counters. Capacity and length
+ * are in bytes, summed over all live CharDna instances.
+ */
+struct DnaStatsSnapshot
+{
+    uint_fast64_t allocations;
+    uint_fast64_t reallocs;
+    uint_fast64_t bytes_allocated;
+    uint_fast64_t bytes_copied;
+    uint_fast64_t copy_constructions;
+    uint_fast64_t live_capacity;
+    uint_fast64_t live_len;
+    uint_fast64_t peak_capacity;
+
+    //Bytes allocated but not in use by any genome.
+    uint_fast64_t slack() const
+    {
+        return live_capacity - live_len;
+    }
+};
+
+class DnaStats
+{
+#ifdef fn_DNA_STATS
+private:
+    static inline std::atomic<uint_fast64_t> s_allocations{0};
+    static inline std::atomic<uint_fast64_t> s_reallocs{0};
+    static inline std::atomic<uint_fast64_t> s_bytes_allocated{0};
+    static inline std::atomic<uint_fast64_t> s_bytes_copied{0};
+    static inline std::atomic<uint_fast64_t> s_copy_constructions{0};
+    static inline std::atomic<uint_fast64_t> s_live_capacity{0};
+    static inline std::atomic<uint_fast64_t> s_live_len{0};
+    static inline std::atomic<uint_fast64_t> s_peak_capacity{0};
+
+    static void add_capacity(uint_fast64_t bytes)
+    {
+        uint_fast64_t now = s_live_capacity.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        uint_fast64_t peak = s_peak_capacity.load(std::memory_order_relaxed);
+        while(now > peak && !s_peak_capacity.compare_exchange_weak(peak, now, std::memory_order_relaxed))
+        {
+        }
+    }
+
+public:
+    static constexpr bool enabled = true;
+
+    static void on_alloc(uint_fast64_t capacity)
+    {
+        s_allocations.fetch_add(1, std::memory_order_relaxed);
+        s_bytes_allocated.fetch_add(capacity, std::memory_order_relaxed);
+        add_capacity(capacity);
+    }
+
+    static void on_free(uint_fast64_t capacity, uint_fast64_t len)
+    {
+        s_live_capacity.fetch_sub(capacity, std::memory_order_relaxed);
+        s_live_len.fetch_sub(len, std::memory_order_relaxed);
+    }
+
+    static void on_realloc(uint_fast64_t oldCapacity, uint_fast64_t newCapacity, uint_fast64_t copied)
+    {
+        s_reallocs.fetch_add(1, std::memory_order_relaxed);
+        s_allocations.fetch_add(1, std::memory_order_relaxed);
+        s_bytes_allocated.fetch_add(newCapacity, std::memory_order_relaxed);
+        s_bytes_copied.fetch_add(copied, std::memory_order_relaxed);
+        add_capacity(newCapacity);
+        s_live_capacity.fetch_sub(oldCapacity, std::memory_order_relaxed);
+    }
+
+    static void on_copy(uint_fast64_t bytes)
+    {
+        s_bytes_copied.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    static void on_copy_construct()
+    {
+        s_copy_constructions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void on_grow(uint_fast64_t bytes)
+    {
+        s_live_len.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    static void on_shrink(uint_fast64_t bytes)
+    {
+        s_live_len.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    static DnaStatsSnapshot snapshot()
+    {
+        DnaStatsSnapshot s;
+        s.allocations = s_allocations.load(std::memory_order_relaxed);
+        s.reallocs = s_reallocs.load(std::memory_order_relaxed);
+        s.bytes_allocated = s_bytes_allocated.load(std::memory_order_relaxed);
+        s.bytes_copied = s_bytes_copied.load(std::memory_order_relaxed);
+        s.copy_constructions = s_copy_constructions.load(std::memory_order_relaxed);
+        s.live_capacity = s_live_capacity.load(std::memory_order_relaxed);
+        s.live_len = s_live_len.load(std::memory_order_relaxed);
+        s.peak_capacity = s_peak_capacity.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    /**
+     * Clears the event counters and resets the peak to the current live
+     * capacity. Live totals are kept, since genomes still hold that memory.
+     */
+    static void reset()
+    {
+        s_allocations.store(0, std::memory_order_relaxed);
+        s_reallocs.store(0, std::memory_order_relaxed);
+        s_bytes_allocated.store(0, std::memory_order_relaxed);
+        s_bytes_copied.store(0, std::memory_order_relaxed);
+        s_copy_constructions.store(0, std::memory_order_relaxed);
+        s_peak_capacity.store(s_live_capacity.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+#else
+public:
+    static constexpr bool enabled = false;
+
+    static void on_alloc(uint_fast64_t) {}
+    static void on_free(uint_fast64_t, uint_fast64_t) {}
+    static void on_realloc(uint_fast64_t, uint_fast64_t, uint_fast64_t) {}
+    static void on_copy(uint_fast64_t) {}
+    static void on_copy_construct() {}
+    static void on_grow(uint_fast64_t) {}
+    static void on_shrink(uint_fast64_t) {}
+
+    static DnaStatsSnapshot snapshot()
+    {
+        return DnaStatsSnapshot{0, 0, 0, 0, 0, 0, 0, 0};
+    }
+
+    static void reset() {}
+#endif
+};
+
+#endif
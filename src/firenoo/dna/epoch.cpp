@@ -0,0 +1,79 @@
+#include <thread>
+
+#include "epoch.h"
+
+namespace
+{
+
+//Releases the thread's slot when the thread exits.
+struct SlotOwner
+{
+    std::atomic<bool>* owned = nullptr;
+
+    ~SlotOwner()
+    {
+        if(owned != nullptr)
+        {
+            owned->store(false, std::memory_order_release);
+        }
+    }
+};
+
+thread_local SlotOwner t_owner;
+
+} //namespace
+
+EpochDomain::EpochDomain() :
+    m_epoch(1)
+{
+    for(unsigned int i = 0; i < kSlots; i++)
+    {
+        m_slots[i].epoch.store(kIdle, std::memory_order_relaxed);
+        m_slots[i].owned.store(false, std::memory_order_relaxed);
+    }
+}
+
+EpochDomain& EpochDomain::global()
+{
+    static EpochDomain domain;
+    return domain;
+}
+
+EpochDomain::Slot* EpochDomain::local_slot()
+{
+    static thread_local Slot* t_slot = nullptr;
+    if(t_slot != nullptr)
+    {
+        return t_slot;
+    }
+    for(;;)
+    {
+        for(unsigned int i = 0; i < kSlots; i++)
+        {
+            bool expected = false;
+            if(!m_slots[i].owned.load(std::memory_order_relaxed)
+                && m_slots[i].owned.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            {
+                t_slot = &m_slots[i];
+                t_owner.owned = &m_slots[i].owned;
+                return t_slot;
+            }
+        }
+        //Every slot is taken; wait for a reader thread to exit.
+        std::this_thread::yield();
+    }
+}
+
+uint_fast64_t EpochDomain::min_active() const
+{
+    uint_fast64_t min = kIdle;
+    for(unsigned int i = 0; i < kSlots; i++)
+    {
+        uint_fast64_t e = m_slots[i].epoch.load(std::memory_order_acquire);
+        if(e < min)
+        {
+            min = e;
+        }
+    }
+    return min;
+}
@@ -0,0 +1,94 @@
+#ifndef fn_EPOCH_H
+#define fn_EPOCH_H
+
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * Epoch-based reclamation for memory that lock-free readers may still be
+ * looking at. Readers hold an EpochDomain::Guard while they dereference shared
+ * pointers. A writer that unlinks a block tags it with retire_tag() and frees
+ * it once safe_to_free(tag) is true.
+ *
+ * Each reading thread claims one of kSlots slots on first use and gives it up
+ * when it exits. Threads beyond kSlots wait for a free slot.
+ */
+class EpochDomain
+{
+public:
+    static const unsigned int kSlots = 256;
+    static const uint_fast64_t kIdle = UINT64_MAX;
+
+private:
+    struct alignas(64) Slot
+    {
+        std::atomic<uint_fast64_t> epoch;
+        std::atomic<bool> owned;
+    };
+
+    Slot m_slots[kSlots];
+    std::atomic<uint_fast64_t> m_epoch;
+
+    Slot* local_slot();
+    static inline thread_local unsigned int t_depth = 0;
+
+    EpochDomain();
+
+public:
+    //The process-wide domain; nesting depth is tracked per thread, so there
+    //is only one.
+    static EpochDomain& global();
+
+    /**
+     * Marks the calling thread as reading for its lifetime. Guards nest; only
+     * the outermost one publishes and clears the epoch.
+     */
+    class Guard
+    {
+    private:
+        Slot* m_slot;
+    public:
+        explicit Guard(EpochDomain& domain) :
+            m_slot(nullptr)
+        {
+            if(t_depth++ == 0)
+            {
+                m_slot = domain.local_slot();
+                m_slot->epoch.store(domain.m_epoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+                //The epoch must be visible before any shared pointer is loaded.
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+            }
+        }
+
+        ~Guard()
+        {
+            if(--t_depth == 0)
+            {
+                m_slot->epoch.store(kIdle, std::memory_order_release);
+            }
+        }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+    };
+
+    /**
+     * Call after unlinking a block. Returns the tag to pass to safe_to_free().
+     */
+    uint_fast64_t retire_tag()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return m_epoch.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    //Whether no reader that could have seen a block retired with tag remains.
+    bool safe_to_free(uint_fast64_t tag) const
+    {
+        return min_active() > tag;
+    }
+
+    //Oldest epoch any reader is in, or kIdle if none is reading.
+    uint_fast64_t min_active() const;
+};
+
+#endif
@@ -0,0 +1,63 @@
+//Writes a genome through both typed wrappers, then round-trips it through
+//serialize()/deserialize() and prints the bytes. Also reads the file back
+//with 64 byte units to exercise the unit size conversion.
+//The file goes to argv[1], or to the temp directory if no path is given.
+#include <string.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../dna.h"
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : (std::filesystem::temp_directory_path() / "typeddna_roundtrip.bin").string();
+    std::shared_ptr<CharDna> dptr = std::make_shared<CharDna>(0, 16);
+    Long64Dna wrap64(dptr);
+    Int32Dna wrap32(dptr);
+    wrap32.append_int(0xff04);
+    wrap64.append_long(0xffffffffffff11);
+    for(unsigned int i = 0; i < dptr->capacity(); i++)
+    {
+        std::cout << (unsigned int)(dptr->char_data(i) & 0xff) << '-';
+    }
+    std::cout <<std::endl;
+    serialize(path, {dptr.get()});
+    std::vector<CharDna> result;
+    result.reserve(2);
+    if(deserialize(path, result))
+    {
+        for(CharDna& d : result)
+        {
+            for(unsigned int i = 0; i < d.capacity(); i++)
+            {
+                std::cout << (unsigned int)(d.char_data(i) & 0xff) << '-';
+            }
+        }
+    }
+    std::cout <<std::endl;
+    //Read the same file with cache line units; only the capacity changes.
+    std::vector<LineDna> lines;
+    if(!deserialize(path, lines) || lines.size() != 1 || lines[0].len() != dptr->len()
+        || memcmp(lines[0].all_data(), dptr->all_data(), dptr->len()) != 0)
+    {
+        std::cout << "unit size conversion failed" << std::endl;
+        return 1;
+    }
+    std::cout << "line units: capacity=" << lines[0].capacity() << std::endl;
+    std::remove(path.c_str());
+    if(DnaStats::enabled)
+    {
+        DnaStatsSnapshot st = DnaStats::snapshot();
+        std::cout << "allocations=" << st.allocations << " reallocs=" << st.reallocs
+                  << " bytes_copied=" << st.bytes_copied << " copies=" << st.copy_constructions
+                  << " peak_capacity=" << st.peak_capacity << " slack=" << st.slack() << std::endl;
+    }
+#ifdef fn_DNA_TIMING
+    PhaseTimings::report(std::cout);
+#endif
+    return 0;
+}
@@ -0,0 +1,161 @@
+#include <string.h>
+
+#include "fitness_cache.h"
+
+FitnessCache::FitnessCache(size_t capacity, bool verify, unsigned int shards) :
+    m_shard_count(shards == 0 ? 1 : shards),
+    m_verify(verify)
+{
+    m_shards.reset(new Shard[m_shard_count]);
+    m_shard_capacity = (capacity + m_shard_count - 1) / m_shard_count;
+    if(m_shard_capacity == 0)
+    {
+        m_shard_capacity = 1;
+    }
+}
+
+void FitnessCache::unlink(Shard& s, uint32_t n)
+{
+    Node& node = s.nodes[n];
+    if(node.prev != kNil)
+    {
+        s.nodes[node.prev].next = node.next;
+    } else
+    {
+        s.head = node.next;
+    }
+    if(node.next != kNil)
+    {
+        s.nodes[node.next].prev = node.prev;
+    } else
+    {
+        s.tail = node.prev;
+    }
+}
+
+void FitnessCache::push_front(Shard& s, uint32_t n)
+{
+    Node& node = s.nodes[n];
+    node.prev = kNil;
+    node.next = s.head;
+    if(s.head != kNil)
+    {
+        s.nodes[s.head].prev = n;
+    } else
+    {
+        s.tail = n;
+    }
+    s.head = n;
+}
+
+bool FitnessCache::matches(const Node& n, const CharDna& genome) const
+{
+    return !m_verify || (n.seed == genome.seed() && n.bytes.size() == genome.len()
+        && memcmp(n.bytes.data(), genome.all_data(), genome.len()) == 0);
+}
+
+bool FitnessCache::lookup(const DnaHash128& key, const CharDna& genome, double& fitness)
+{
+    Shard& s = shard(key);
+    std::lock_guard<std::mutex> lock(s.lock);
+    auto it = s.index.find(key);
+    if(it == s.index.end() || !matches(s.nodes[it->second], genome))
+    {
+        s.misses++;
+        return false;
+    }
+    uint32_t n = it->second;
+    if(s.head != n)
+    {
+        unlink(s, n);
+        push_front(s, n);
+    }
+    fitness = s.nodes[n].fitness;
+    s.hits++;
+    return true;
+}
+
+void FitnessCache::insert(const DnaHash128& key, const CharDna& genome, double fitness)
+{
+    Shard& s = shard(key);
+    std::lock_guard<std::mutex> lock(s.lock);
+    uint32_t n;
+    auto it = s.index.find(key);
+    if(it != s.index.end())
+    {
+        n = it->second;
+        unlink(s, n);
+    } else if(s.nodes.size() < m_shard_capacity)
+    {
+        n = static_cast<uint32_t>(s.nodes.size());
+        s.nodes.emplace_back();
+        s.index.emplace(key, n);
+    } else
+    {
+        //Reuse the least recently used node.
+        n = s.tail;
+        unlink(s, n);
+        s.index.erase(s.nodes[n].key);
+        s.index.emplace(key, n);
+    }
+    Node& node = s.nodes[n];
+    node.key = key;
+    node.fitness = fitness;
+    if(m_verify)
+    {
+        node.seed = genome.seed();
+        node.bytes.assign(genome.all_data(), genome.len());
+    }
+    push_front(s, n);
+}
+
+void FitnessCache::clear()
+{
+    for(unsigned int i = 0; i < m_shard_count; i++)
+    {
+        Shard& s = m_shards[i];
+        std::lock_guard<std::mutex> lock(s.lock);
+        s.nodes.clear();
+        s.index.clear();
+        s.head = kNil;
+        s.tail = kNil;
+        s.hits = 0;
+        s.misses = 0;
+    }
+}
+
+size_t FitnessCache::size() const
+{
+    size_t total = 0;
+    for(unsigned int i = 0; i < m_shard_count; i++)
+    {
+        Shard& s = m_shards[i];
+        std::lock_guard<std::mutex> lock(s.lock);
+        total += s.nodes.size();
+    }
+    return total;
+}
+
+uint_fast64_t FitnessCache::hits() const
+{
+    uint_fast64_t total = 0;
+    for(unsigned int i = 0; i < m_shard_count; i++)
+    {
+        Shard& s = m_shards[i];
+        std::lock_guard<std::mutex> lock(s.lock);
+        total += s.hits;
+    }
+    return total;
+}
+
+uint_fast64_t FitnessCache::misses() const
+{
+    uint_fast64_t total = 0;
+    for(unsigned int i = 0; i < m_shard_count; i++)
+    {
+        Shard& s = m_shards[i];
+        std::lock_guard<std::mutex> lock(s.lock);
+        total += s.misses;
+    }
+    return total;
+}
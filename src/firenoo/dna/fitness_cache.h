@@ -0,0 +1,130 @@
+#ifndef fn_FITNESS_CACHE_H
+#define fn_FITNESS_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "char_dna.h"
+#include "dna_hash.h"
+
+/**
+ * Bounded memo of fitness values, keyed by a 128-bit hash of a genome's
+ * bytes seeded with its seed, so unchanged elites and duplicate offspring
+ * are not evaluated again.
+ *
+ * Entries are spread over shards by hash; each shard has its own lock and
+ * evicts its least recently used entry when full. With verify set, entries
+ * also keep the genome's bytes and seed and a hit requires them to match,
+ * which rules out hash collisions at the cost of a copy per entry.
+ */
+class FitnessCache
+{
+private:
+    static const uint32_t kNil = UINT32_MAX;
+
+    struct Node
+    {
+        DnaHash128 key;
+        double fitness;
+        uint32_t prev;
+        uint32_t next;
+        //Verify mode only.
+        uint_fast64_t seed;
+        std::string bytes;
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const DnaHash128& k) const
+        {
+            return static_cast<size_t>(k.lo);
+        }
+    };
+
+    //Nodes are linked most recently used first.
+    struct Shard
+    {
+        std::mutex lock;
+        std::vector<Node> nodes;
+        std::unordered_map<DnaHash128, uint32_t, KeyHash> index;
+        uint32_t head = kNil;
+        uint32_t tail = kNil;
+        uint_fast64_t hits = 0;
+        uint_fast64_t misses = 0;
+    };
+
+    std::unique_ptr<Shard[]> m_shards;
+    unsigned int m_shard_count;
+    size_t m_shard_capacity;
+    bool m_verify;
+
+    Shard& shard(const DnaHash128& key) const
+    {
+        return m_shards[key.hi % m_shard_count];
+    }
+
+    static void unlink(Shard& s, uint32_t n);
+    static void push_front(Shard& s, uint32_t n);
+    bool matches(const Node& n, const CharDna& genome) const;
+
+public:
+    /**
+     * Holds up to capacity entries, rounded up to a multiple of shards.
+     */
+    FitnessCache(size_t capacity, bool verify = false, unsigned int shards = 16);
+    FitnessCache(const FitnessCache&) = delete;
+    FitnessCache& operator=(const FitnessCache&) = delete;
+
+    static DnaHash128 key(const CharDna& genome)
+    {
+        return hash_bytes(genome.all_data(), genome.len(), genome.seed());
+    }
+
+    /**
+     * Sets fitness and returns true if the genome is cached, marking it most
+     * recently used. key must be key(genome).
+     */
+    bool lookup(const DnaHash128& key, const CharDna& genome, double& fitness);
+
+    bool lookup(const CharDna& genome, double& fitness)
+    {
+        return lookup(key(genome), genome, fitness);
+    }
+
+    /**
+     * Stores or replaces the genome's fitness, evicting the shard's least
+     * recently used entry if it is full.
+     */
+    void insert(const DnaHash128& key, const CharDna& genome, double fitness);
+
+    void insert(const CharDna& genome, double fitness)
+    {
+        insert(key(genome), genome, fitness);
+    }
+
+    //Drops every entry and zeroes hits() and misses().
+    void clear();
+
+    bool verify() const
+    {
+        return m_verify;
+    }
+
+    size_t capacity() const
+    {
+        return m_shard_capacity * m_shard_count;
+    }
+
+    size_t size() const;
+
+    uint_fast64_t hits() const;
+
+    uint_fast64_t misses() const;
+};
+
+#endif
@@ -0,0 +1,227 @@
+#ifndef fn_GENE_H
+#define fn_GENE_H
+
+#include <stdint.h>
+
+#include "defs.h"
+
+#define errOVERRIDE 1
+class Gene
+{
+private:
+    //(0) header
+    //(1) data1 - chunks are always stored biggest to smallest.
+    //(2) data2
+    //(3) dominance
+    uint_fast64_t m_data[5];
+    uint_fast32_t m_error;
+    //# of bytes, shorts, ints.
+    unsigned char m_slot;
+
+    Gene* set_data(uint_fast64_t d1, uint_fast64_t d2, unsigned int mask, unsigned int slot)
+    {
+        //clear bits in slots
+        *(m_data + 2) &= ~mask << (slot * 8);
+        *(m_data + 3) &= ~mask << (slot * 8);
+        //set data in slot
+        *(m_data + 2) |= (d1 & mask) << (slot * 8);
+        *(m_data + 3) |= (d2 & mask) << (slot * 8);
+        return this;
+    }
+
+public:
+    Gene() :
+        m_data{0, 0, 0, 0, 0},
+        m_error(0),
+        m_slot(0)
+    {
+    }
+
+    /*
+     * Rebuilds a gene from the five words returned by get_data() and its
+     * slot count, e.g. when loading a population image.
+     */
+    Gene(const uint_fast64_t* data, unsigned char slot) :
+        m_data{data[0], data[1], data[2], data[3], data[4]},
+        m_error(0),
+        m_slot(slot)
+    {
+    }
+
+    /*
+     * Whether an error occurred since the last operation.
+     */
+    bool is_err()
+    {
+        return m_error;
+    }
+
+    void clear_err()
+    {
+        m_error = 0;
+    }
+
+
+    /*
+     * Clears the specifed error bit(s). Argument is a bit field for which
+     * each set bit is cleared in the error bit.
+     */
+    void clear_err(uint_fast32_t bit)
+    {
+        m_error &= ~bit;
+    }
+
+    bool err_override()
+    {
+        return (m_error & errOVERRIDE);
+    }
+    
+    /*
+     * Adds the 64-bit data to the next available data slot. On success, all
+     * error flags are cleared.
+     * 
+     * d1, d2   - the data blocks to add.
+     * force    - If there is not enough space in this gene, setting this to true will
+     *            allow the algorithm to override bits starting from the oldest entry. The
+     *            override flag is then set. Otherwise this method does nothing.
+     * Special case for 64-bit: If force is true, all bits are overriden; it is equivalent
+     * to calling clear_data() then calling this method. The override error flag is then set.
+     * Otherwise, this method does nothing.
+     */ 
+    Gene* append_64(uint_fast64_t d1, uint_fast64_t d2, char dom1, char dom2, bool force)
+    {
+        if(force)
+        {
+            clear_data();
+            m_error |= errOVERRIDE;   
+        } else if(m_slot != 0)
+        {
+            //Do nothing
+            return this;
+        }
+        m_data[1] = d1;
+        m_data[2] = d2;
+        m_data[3] |= dom1;
+        m_data[4] |= dom2;
+        m_slot = 8;
+        return this;
+    }
+
+    /*
+     * Adds the 32-bit data to the next available data slot. On success, all
+     * error flags are cleared.
+     * 
+     * d1, d2   - the data blocks to add.
+     * force    - If there is not enough space in this gene, setting this to true will
+     *            allow the algorithm to override bits starting from the oldest entry. The
+     *            override flag is then set. Otherwise this method does nothing and the override 
+     *            flag is set.
+     * There are up to 2 available slots for 32-bit data.
+     */ 
+    Gene* append_32(uint_fast32_t d1, uint_fast32_t d2, char dom1, char dom2, bool force)
+    {
+        char index;
+        if(m_slot > 4 && !force)
+        {
+            m_error |= 1;
+            return this;
+        } else if(m_slot > 4)
+        {
+            m_slot = 4;
+            index = 32;
+            m_data[1] &= 0xffffffff;
+            m_data[2] &= 0xffffffff;
+            m_error |= errOVERRIDE;
+            m_data[3] &= 0xff << m_slot * 8;
+            m_data[4] &= 0xff << m_slot * 8;
+        } else
+        {
+            index = m_slot * 8;
+        }
+        
+        m_data[1] |= static_cast<uint_fast64_t>(d1) << index;
+        m_data[2] |= static_cast<uint_fast64_t>(d2) << index;
+        m_data[3] |= static_cast<uint_fast64_t>(dom1 & 0xff) << index;
+        m_data[4] |= static_cast<uint_fast64_t>(dom2 & 0xff) << index;
+        m_slot += 4;
+        return this;
+    }
+
+   /*
+     * Adds the 16-bit data to the next available data slot. On success, all
+     * error flags are cleared.
+     * 
+     * d1, d2   - the data blocks to add.
+     * force    - If there is not enough space in this gene, setting this to true will
+     *            allow the algorithm to override bits starting from the oldest entry. The
+     *            override flag is then set. Otherwise this method does nothing and the override 
+     *            flag is set.
+     * There are up to 4 available slots for 16-bit data.
+     */ 
+    Gene* append_16(uint_fast32_t d1, uint_fast32_t d2, char dom1, char dom2, bool force)
+    {
+        char index;
+        if(m_slot > 6 && !force)
+        {
+            m_error |= 1;
+            return this;
+        } else if(m_slot > 4)
+        {
+            m_slot = 4;
+            index = 48;
+            m_data[1] &= 0xffffffff;
+            m_data[2] &= 0xffffffff;
+            m_error |= errOVERRIDE;
+            m_data[3] &= 0xff << m_slot * 8;
+            m_data[4] &= 0xff << m_slot * 8;
+        } else
+        {
+            index = m_slot * 8;
+        }
+        
+        m_data[1] |= static_cast<uint_fast64_t>(d1) << index;
+        m_data[2] |= static_cast<uint_fast64_t>(d2) << index;
+        m_data[3] |= static_cast<uint_fast64_t>(dom1 & 0xff) << index;
+        m_data[4] |= static_cast<uint_fast64_t>(dom2 & 0xff) << index;
+        m_slot += 4;
+        return this;
+    }
+    /*
+     * Adds the 8-bit data to the next available data slot.
+     * 
+     * d1, d2   - the data blocks to add.
+     * type     - type. Use the defined macros, fn_BYTE, fn_SHORT, etc. Invalid
+     *            values are treated as fn_BYTE.
+     *            If there is not enough room, 
+     */ 
+    Gene* append_8(uint_fast32_t d1, uint_fast32_t d2, char dom1, char dom2)
+    {
+        
+        
+        return this;
+    }
+
+
+
+    Gene* clear_data()
+    {
+        m_slot = 0;
+        m_data[1] = 0;
+        m_data[2] = 0;
+        m_data[3] = 0;
+        return this;
+    }
+
+    const uint_fast64_t* get_data() const
+    {
+        return const_cast<const uint_fast64_t*>(m_data);
+    }
+
+    //Number of data slots in use.
+    unsigned char slot() const
+    {
+        return m_slot;
+    }
+};
+
+#endif
@@ -0,0 +1,209 @@
+#include <string.h>
+
+#include "genome_init.h"
+#include "uint128.h"
+
+#if defined(__SSE2__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#include <emmintrin.h>
+#define fn_INIT_SSE2 1
+#endif
+
+namespace
+{
+
+const unsigned int kLanes = 4;
+//Bytes produced per step of all lanes.
+const size_t kStep = kLanes * 8;
+
+uint64_t splitmix64(uint64_t& state)
+{
+    uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+struct Lanes
+{
+    uint64_t s0[kLanes];
+    uint64_t s1[kLanes];
+
+    explicit Lanes(uint64_t seed)
+    {
+        for(unsigned int j = 0; j < kLanes; j++)
+        {
+            s0[j] = splitmix64(seed);
+            s1[j] = splitmix64(seed);
+        }
+    }
+
+    //One xorshift128+ step of every lane, lane j to out[j * 8], little endian.
+    void step(char* out)
+    {
+        for(unsigned int j = 0; j < kLanes; j++)
+        {
+            uint64_t x = s0[j];
+            uint64_t y = s1[j];
+            uint64_t r = x + y;
+            s0[j] = y;
+            x ^= x << 23;
+            s1[j] = x ^ y ^ (x >> 17) ^ (y >> 26);
+            for(unsigned int b = 0; b < 8; b++)
+            {
+                out[j * 8 + b] = static_cast<char>(r >> (8 * b));
+            }
+        }
+    }
+};
+
+uint64_t load_le(const char* p, unsigned int width)
+{
+    uint64_t v = 0;
+    for(unsigned int b = 0; b < width; b++)
+    {
+        v |= static_cast<uint64_t>(static_cast<unsigned char>(p[b])) << (8 * b);
+    }
+    return v;
+}
+
+void store_le(char* p, unsigned int width, uint64_t v)
+{
+    for(unsigned int b = 0; b < width; b++)
+    {
+        p[b] = static_cast<char>(v >> (8 * b));
+    }
+}
+
+uint64_t width_mask(unsigned int width)
+{
+    return width == 8 ? ~0ull : (1ull << (8 * width)) - 1;
+}
+
+} //namespace
+
+uint_fast32_t GenomeSchema::add(unsigned int width, uint64_t lo, uint64_t hi)
+{
+    if(width != fn_BYTE && width != fn_SHORT && width != fn_INT && width != fn_LONG)
+    {
+        width = fn_BYTE;
+    }
+    uint64_t mask = width_mask(width);
+    hi = hi > mask ? mask : hi;
+    lo = lo > hi ? hi : lo;
+    Field f;
+    f.offset = (m_bytes + width - 1) / width * width;
+    f.width = width;
+    f.lo = lo;
+    f.hi = hi;
+    m_fields.push_back(f);
+    m_bytes = f.offset + width;
+    return f.offset;
+}
+
+void random_fill(char* out, size_t len, uint_fast64_t seed)
+{
+    Lanes lanes(seed);
+    size_t i = 0;
+#ifdef fn_INIT_SSE2
+    //Lanes 0-1 in a, lanes 2-3 in b; same recurrence as Lanes::step().
+    __m128i a0 = _mm_set_epi64x(static_cast<long long>(lanes.s0[1]), static_cast<long long>(lanes.s0[0]));
+    __m128i a1 = _mm_set_epi64x(static_cast<long long>(lanes.s1[1]), static_cast<long long>(lanes.s1[0]));
+    __m128i b0 = _mm_set_epi64x(static_cast<long long>(lanes.s0[3]), static_cast<long long>(lanes.s0[2]));
+    __m128i b1 = _mm_set_epi64x(static_cast<long long>(lanes.s1[3]), static_cast<long long>(lanes.s1[2]));
+    for(; i + kStep <= len; i += kStep)
+    {
+        __m128i ra = _mm_add_epi64(a0, a1);
+        __m128i rb = _mm_add_epi64(b0, b1);
+        __m128i xa = _mm_xor_si128(a0, _mm_slli_epi64(a0, 23));
+        __m128i xb = _mm_xor_si128(b0, _mm_slli_epi64(b0, 23));
+        a0 = a1;
+        b0 = b1;
+        a1 = _mm_xor_si128(_mm_xor_si128(xa, a0), _mm_xor_si128(_mm_srli_epi64(xa, 17), _mm_srli_epi64(a0, 26)));
+        b1 = _mm_xor_si128(_mm_xor_si128(xb, b0), _mm_xor_si128(_mm_srli_epi64(xb, 17), _mm_srli_epi64(b0, 26)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), ra);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 16), rb);
+    }
+    //Hand the state back for the tail.
+    uint64_t tmp[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(tmp), a0);
+    lanes.s0[0] = tmp[0];
+    lanes.s0[1] = tmp[1];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(tmp), a1);
+    lanes.s1[0] = tmp[0];
+    lanes.s1[1] = tmp[1];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(tmp), b0);
+    lanes.s0[2] = tmp[0];
+    lanes.s0[3] = tmp[1];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(tmp), b1);
+    lanes.s1[2] = tmp[0];
+    lanes.s1[3] = tmp[1];
+#endif
+    for(; i + kStep <= len; i += kStep)
+    {
+        lanes.step(out + i);
+    }
+    if(i < len)
+    {
+        char last[kStep];
+        lanes.step(last);
+        memcpy(out + i, last, len - i);
+    }
+}
+
+void apply_schema(char* genome, const GenomeSchema& schema)
+{
+    for(const GenomeSchema::Field& f : schema.fields())
+    {
+        char* p = genome + f.offset;
+        uint64_t r = load_le(p, f.width);
+        uint64_t span = f.hi - f.lo;
+        if(span != width_mask(f.width))
+        {
+            //Multiply-shift maps [0, 2^bits) onto [0, span] without division.
+            //Below 64 bits the product fits in 64 bits.
+            r = f.lo + (f.width == fn_LONG ? Uint128::mul(r, span + 1).hi : (r * (span + 1)) >> (8 * f.width));
+        }
+        store_le(p, f.width, r);
+    }
+}
+
+std::vector<CharDna> random_population(const std::vector<uint_fast64_t>& seeds, uint_fast32_t len,
+    const GenomeSchema* schema)
+{
+    if(schema != nullptr && len < schema->bytes())
+    {
+        len = schema->bytes();
+    }
+    std::vector<CharDna> out;
+    out.reserve(seeds.size());
+    for(uint_fast64_t seed : seeds)
+    {
+        out.emplace_back(seed, len);
+        CharDna& d = out.back();
+        random_fill(d, len);
+        if(schema != nullptr)
+        {
+            apply_schema(d.resize(len), *schema);
+        }
+    }
+    return out;
+}
+
+int random_slab(char* slab, size_t stride, const std::vector<uint_fast64_t>& seeds, uint_fast32_t len,
+    const GenomeSchema* schema)
+{
+    if(len > stride || (schema != nullptr && len < schema->bytes()))
+    {
+        return 0;
+    }
+    for(size_t i = 0; i < seeds.size(); i++)
+    {
+        char* g = slab + i * stride;
+        random_fill(g, len, seeds[i]);
+        if(schema != nullptr)
+        {
+            apply_schema(g, *schema);
+        }
+    }
+    return 1;
+}
@@ -0,0 +1,99 @@
+#ifndef fn_GENOME_INIT_H
+#define fn_GENOME_INIT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#include "char_dna.h"
+
+//Bulk random initialization of genomes. Bytes come from four interleaved
+//xorshift128+ streams seeded from the genome's seed, stepped two lanes per
+//SSE2 register where available. The portable path produces the same bytes,
+//so a genome's content depends only on its seed and length.
+
+/**
+ * Layout of typed values in a genome. Fields are placed in the order added,
+ * each aligned to its own width like Int32Dna and Long64Dna do, and stored
+ * little endian.
+ */
+class GenomeSchema
+{
+public:
+    struct Field
+    {
+        uint_fast32_t offset;
+        //fn_BYTE, fn_SHORT, fn_INT or fn_LONG.
+        unsigned int width;
+        uint64_t lo;
+        uint64_t hi;
+    };
+
+private:
+    std::vector<Field> m_fields;
+    uint_fast32_t m_bytes;
+
+public:
+    GenomeSchema() :
+        m_bytes(0)
+    {
+    }
+
+    /**
+     * Adds a field of width bytes whose random values fall in [lo, hi],
+     * compared as unsigned. Invalid widths are treated as fn_BYTE, and hi is
+     * clamped to the largest value the width holds. Returns the field's
+     * offset in bytes.
+     */
+    uint_fast32_t add(unsigned int width, uint64_t lo, uint64_t hi);
+
+    const std::vector<Field>& fields() const
+    {
+        return m_fields;
+    }
+
+    //Genome length covering every field.
+    uint_fast32_t bytes() const
+    {
+        return m_bytes;
+    }
+};
+
+/**
+ * Fills len bytes at out with the random stream for seed.
+ */
+void random_fill(char* out, size_t len, uint_fast64_t seed);
+
+/**
+ * Fills the genome up to len bytes with the stream for its seed, replacing
+ * its content.
+ */
+template<uint_fast32_t UnitSize>
+void random_fill(BasicCharDna<UnitSize>& genome, uint_fast32_t len)
+{
+    random_fill(genome.resize(len), len, genome.seed());
+}
+
+/**
+ * Maps the raw random bytes of each schema field into its range. Bytes
+ * outside the fields are left as they are.
+ */
+void apply_schema(char* genome, const GenomeSchema& schema);
+
+/**
+ * Builds count genomes of len bytes, genome i with seed seeds[i]. A schema,
+ * if given, is applied to each; len is raised to schema.bytes() if shorter.
+ */
+std::vector<CharDna> random_population(const std::vector<uint_fast64_t>& seeds, uint_fast32_t len,
+    const GenomeSchema* schema = nullptr);
+
+/**
+ * Fills a contiguous slab of seeds.size() genomes, genome i at
+ * slab + i * stride, with its first len bytes random. The rest of each
+ * stride is left untouched. Returns 0 without writing if len exceeds
+ * stride or does not cover schema.bytes(), 1 otherwise.
+ */
+int random_slab(char* slab, size_t stride, const std::vector<uint_fast64_t>& seeds, uint_fast32_t len,
+    const GenomeSchema* schema = nullptr);
+
+#endif
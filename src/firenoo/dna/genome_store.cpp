@@ -0,0 +1,177 @@
+#include <string.h>
+#include <unordered_map>
+
+#include "genome_store.h"
+#include "serialize.h"
+
+GenomeStore::GenomeStore() :
+    m_payloads(0),
+    m_bytes(0),
+    m_hits(0)
+{
+}
+
+uint_fast64_t GenomeStore::intern(const char* data, uint_fast32_t len)
+{
+    DnaHash128 hash = hash_bytes(data, len);
+    std::lock_guard<std::mutex> lock(m_lock);
+    auto range = m_index.equal_range(hash.lo);
+    for(auto it = range.first; it != range.second; ++it)
+    {
+        Entry& e = m_entries[it->second];
+        if(e.hash == hash && e.len == len && memcmp(e.data.get(), data, len) == 0)
+        {
+            e.refs++;
+            m_hits++;
+            return it->second;
+        }
+    }
+    uint_fast64_t id;
+    if(!m_free.empty())
+    {
+        id = m_free.back();
+        m_free.pop_back();
+    } else
+    {
+        id = m_entries.size();
+        m_entries.emplace_back();
+    }
+    Entry& e = m_entries[id];
+    e.hash = hash;
+    e.data.reset(new char[len]);
+    memcpy(e.data.get(), data, len);
+    e.len = len;
+    e.refs = 1;
+    m_index.emplace(hash.lo, id);
+    m_payloads++;
+    m_bytes += len;
+    return id;
+}
+
+void GenomeStore::retain(uint_fast64_t id)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_entries[id].refs++;
+}
+
+bool GenomeStore::release(uint_fast64_t id)
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    Entry& e = m_entries[id];
+    if(e.refs == 0 || --e.refs != 0)
+    {
+        return false;
+    }
+    auto range = m_index.equal_range(e.hash.lo);
+    for(auto it = range.first; it != range.second; ++it)
+    {
+        if(it->second == id)
+        {
+            m_index.erase(it);
+            break;
+        }
+    }
+    m_payloads--;
+    m_bytes -= e.len;
+    e.data.reset();
+    e.len = 0;
+    m_free.push_back(id);
+    return true;
+}
+
+const char* GenomeStore::data(uint_fast64_t id) const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_entries[id].data.get();
+}
+
+uint_fast32_t GenomeStore::len(uint_fast64_t id) const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_entries[id].len;
+}
+
+uint_fast64_t GenomeStore::refs(uint_fast64_t id) const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_entries[id].refs;
+}
+
+CharDna GenomeStore::materialize(uint_fast64_t id, uint_fast64_t seed) const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    const Entry& e = m_entries[id];
+    return CharDna(seed, e.len, e.data.get());
+}
+
+size_t GenomeStore::payloads() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_payloads;
+}
+
+size_t GenomeStore::bytes() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_bytes;
+}
+
+uint_fast64_t GenomeStore::hits() const
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    return m_hits;
+}
+
+int write_store_records(const std::string& path, const GenomeStore& store,
+    const std::vector<StoredGenome>& genomes)
+{
+    std::vector<DnaRecord> records;
+    records.reserve(genomes.size());
+    //Payload id to the first record that wrote it.
+    std::unordered_map<uint_fast64_t, uint_fast32_t> written;
+    for(const StoredGenome& g : genomes)
+    {
+        DnaRecord r{g.seed, CharDna::unit_size, store.len(g.id), store.data(g.id)};
+        auto found = written.find(g.id);
+        if(found != written.end())
+        {
+            r.ref = found->second;
+        } else
+        {
+            written.emplace(g.id, static_cast<uint_fast32_t>(records.size()));
+        }
+        records.push_back(r);
+    }
+    return write_dna_records(path, records);
+}
+
+int read_store_records(const std::string& path, GenomeStore& store, std::vector<StoredGenome>& genomes)
+{
+    //Record index to the id its payload was interned as.
+    std::vector<uint_fast64_t> ids;
+    size_t start = genomes.size();
+    int ok = read_dna_records(path, [&](const DnaRecord& r)
+    {
+        uint_fast64_t id;
+        if(r.ref != DnaRecord::kNoRef)
+        {
+            id = ids[r.ref];
+            store.retain(id);
+        } else
+        {
+            id = store.intern(r.data, r.len);
+        }
+        ids.push_back(id);
+        genomes.push_back(StoredGenome{r.seed, id});
+    });
+    if(!ok)
+    {
+        //Drop the references already taken for a file that failed part way.
+        for(size_t i = start; i < genomes.size(); i++)
+        {
+            store.release(genomes[i].id);
+        }
+        genomes.resize(start);
+    }
+    return ok;
+}
@@ -0,0 +1,112 @@
+#ifndef fn_GENOME_STORE_H
+#define fn_GENOME_STORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "char_dna.h"
+#include "dna_hash.h"
+
+/**
+ * Content-addressed store of genome payloads. Identical byte strings are
+ * kept once and reference counted; a genome is then just its seed plus the
+ * id of its payload. Lookups hash the bytes and compare them in full on a
+ * hash match, so collisions never merge different payloads.
+ *
+ * All methods lock, so islands on different threads can share one store.
+ * A payload's bytes stay at the same address until its last reference is
+ * released.
+ */
+class GenomeStore
+{
+private:
+    struct Entry
+    {
+        DnaHash128 hash;
+        std::unique_ptr<char[]> data;
+        uint_fast32_t len;
+        uint_fast64_t refs;
+    };
+
+    mutable std::mutex m_lock;
+    std::vector<Entry> m_entries;
+    std::vector<uint_fast64_t> m_free;
+    std::unordered_multimap<uint64_t, uint_fast64_t> m_index;
+    size_t m_payloads;
+    size_t m_bytes;
+    uint_fast64_t m_hits;
+
+public:
+    GenomeStore();
+    GenomeStore(const GenomeStore&) = delete;
+    GenomeStore& operator=(const GenomeStore&) = delete;
+
+    /**
+     * Returns the id of the payload equal to data, adding it if new, and
+     * takes one reference to it.
+     */
+    uint_fast64_t intern(const char* data, uint_fast32_t len);
+
+    uint_fast64_t intern(const CharDna& genome)
+    {
+        return intern(genome.all_data(), genome.len());
+    }
+
+    //Takes another reference to id.
+    void retain(uint_fast64_t id);
+
+    /**
+     * Drops one reference to id. Returns true if that freed the payload.
+     */
+    bool release(uint_fast64_t id);
+
+    const char* data(uint_fast64_t id) const;
+
+    uint_fast32_t len(uint_fast64_t id) const;
+
+    uint_fast64_t refs(uint_fast64_t id) const;
+
+    //Copies the payload out as a genome with the given seed.
+    CharDna materialize(uint_fast64_t id, uint_fast64_t seed) const;
+
+    //Distinct payloads currently stored.
+    size_t payloads() const;
+
+    //Payload bytes currently stored, each counted once.
+    size_t bytes() const;
+
+    //intern() calls that found an existing payload.
+    uint_fast64_t hits() const;
+};
+
+/**
+ * Genome held in a GenomeStore.
+ */
+struct StoredGenome
+{
+    uint_fast64_t seed;
+    uint_fast64_t id;
+};
+
+/**
+ * Writes genomes as dna records. Each payload is written once; later genomes
+ * with the same id become references to that record. Returns 1 on success,
+ * 0 on failure.
+ */
+int write_store_records(const std::string& path, const GenomeStore& store,
+    const std::vector<StoredGenome>& genomes);
+
+/**
+ * Reads a dna file into the store, appending one entry per record to
+ * genomes; each entry holds a reference. Payloads the file shares are
+ * interned once. Returns 1 on success, 0 on failure; on failure the
+ * references already taken are released and genomes is left as it was.
+ */
+int read_store_records(const std::string& path, GenomeStore& store, std::vector<StoredGenome>& genomes);
+
+#endif
@@ -0,0 +1,248 @@
+#include <string.h>
+#include <fstream>
+#include <queue>
+
+#include "lineage.h"
+
+namespace
+{
+
+const char kMagic[8] = {'T', 'D', 'N', 'A', 'L', 'I', 'N', '\0'};
+const uint32_t kVersion = 1;
+//Entries converted per write or read call.
+const size_t kChunk = 1 << 14;
+//Two parents, operator and generation.
+const uint64_t kEntryBytes = 8 + 8 + 1 + 4;
+
+//Writes a column little endian, kChunk values at a time.
+template<typename T>
+void write_column(std::ofstream& file, const std::vector<T>& column)
+{
+    std::vector<char> buf(kChunk * sizeof(T));
+    for(size_t at = 0; at < column.size(); at += kChunk)
+    {
+        size_t n = column.size() - at < kChunk ? column.size() - at : kChunk;
+        for(size_t i = 0; i < n; i++)
+        {
+            uint64_t v = column[at + i];
+            for(unsigned int b = 0; b < sizeof(T); b++)
+            {
+                buf[i * sizeof(T) + b] = static_cast<char>(v >> (8 * b));
+            }
+        }
+        file.write(buf.data(), static_cast<std::streamsize>(n * sizeof(T)));
+    }
+}
+
+template<typename T>
+bool read_column(std::ifstream& file, std::vector<T>& column, size_t count)
+{
+    std::vector<char> buf(kChunk * sizeof(T));
+    column.resize(count);
+    for(size_t at = 0; at < count; at += kChunk)
+    {
+        size_t n = count - at < kChunk ? count - at : kChunk;
+        if(!file.read(buf.data(), static_cast<std::streamsize>(n * sizeof(T))))
+        {
+            return false;
+        }
+        for(size_t i = 0; i < n; i++)
+        {
+            uint64_t v = 0;
+            for(unsigned int b = 0; b < sizeof(T); b++)
+            {
+                v |= static_cast<uint64_t>(static_cast<unsigned char>(buf[i * sizeof(T) + b])) << (8 * b);
+            }
+            column[at + i] = static_cast<T>(v);
+        }
+    }
+    return true;
+}
+
+} //namespace
+
+uint64_t LineageLog::record(uint64_t parent_a, uint64_t parent_b, LineageOp op, uint32_t generation)
+{
+    uint64_t id = m_op.size();
+    if((parent_a != kNone && parent_a >= id) || (parent_b != kNone && parent_b >= id))
+    {
+        return kNone;
+    }
+    m_parent_a.push_back(parent_a);
+    m_parent_b.push_back(parent_b);
+    m_op.push_back(static_cast<uint8_t>(op));
+    m_generation.push_back(generation);
+    return id;
+}
+
+std::vector<uint64_t> LineageLog::ancestors(uint64_t id) const
+{
+    //Parents precede children, so popping the largest id first sees each
+    //ancestor's duplicates back to back.
+    std::priority_queue<uint64_t> pending;
+    std::vector<uint64_t> out;
+    if(id >= m_op.size())
+    {
+        return out;
+    }
+    uint64_t last = kNone;
+    pending.push(id);
+    while(!pending.empty())
+    {
+        uint64_t i = pending.top();
+        pending.pop();
+        if(i == last)
+        {
+            continue;
+        }
+        last = i;
+        if(i != id)
+        {
+            out.push_back(i);
+        }
+        if(m_parent_a[i] != kNone)
+        {
+            pending.push(m_parent_a[i]);
+        }
+        if(m_parent_b[i] != kNone)
+        {
+            pending.push(m_parent_b[i]);
+        }
+    }
+    return std::vector<uint64_t>(out.rbegin(), out.rend());
+}
+
+std::vector<uint64_t> LineageLog::descendants(uint64_t id) const
+{
+    std::vector<uint64_t> out;
+    if(id >= m_op.size())
+    {
+        return out;
+    }
+    //in_line[i - id]: whether i descends from id (or is id).
+    std::vector<bool> in_line(m_op.size() - id, false);
+    in_line[0] = true;
+    for(uint64_t i = id + 1; i < m_op.size(); i++)
+    {
+        uint64_t a = m_parent_a[i];
+        uint64_t b = m_parent_b[i];
+        if((a != kNone && a >= id && in_line[a - id]) || (b != kNone && b >= id && in_line[b - id]))
+        {
+            in_line[i - id] = true;
+            out.push_back(i);
+        }
+    }
+    return out;
+}
+
+double LineageLog::contribution(uint64_t id, uint32_t generation) const
+{
+    if(id >= m_op.size())
+    {
+        return 0;
+    }
+    std::vector<double> share(m_op.size() - id, 0.0);
+    share[0] = 1.0;
+    double sum = 0;
+    uint64_t count = 0;
+    for(uint64_t i = 0; i < m_op.size(); i++)
+    {
+        if(i > id)
+        {
+            uint64_t a = m_parent_a[i];
+            uint64_t b = m_parent_b[i];
+            double sa = a != kNone && a >= id ? share[a - id] : 0.0;
+            double sb = b != kNone && b >= id ? share[b - id] : 0.0;
+            if(a != kNone && b != kNone)
+            {
+                share[i - id] = m_op[i] == LINEAGE_CROSSOVER ? 0.5 * (sa + sb) : sa;
+            } else
+            {
+                share[i - id] = a != kNone ? sa : sb;
+            }
+        }
+        if(m_generation[i] == generation)
+        {
+            sum += i >= id ? share[i - id] : 0.0;
+            count++;
+        }
+    }
+    return count == 0 ? 0.0 : sum / count;
+}
+
+void LineageLog::clear()
+{
+    m_parent_a.clear();
+    m_parent_b.clear();
+    m_op.clear();
+    m_generation.clear();
+}
+
+int LineageLog::save(const std::string& path) const
+{
+    std::ofstream file;
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if(!file.is_open())
+    {
+        return 0;
+    }
+    file.write(kMagic, sizeof(kMagic));
+    std::vector<uint32_t> version(1, kVersion);
+    write_column(file, version);
+    std::vector<uint64_t> count(1, m_op.size());
+    write_column(file, count);
+    write_column(file, m_parent_a);
+    write_column(file, m_parent_b);
+    write_column(file, m_op);
+    write_column(file, m_generation);
+    file.flush();
+    bool ok = !file.fail();
+    file.close();
+    return ok ? 1 : 0;
+}
+
+int LineageLog::load(const std::string& path)
+{
+    clear();
+    std::ifstream file;
+    file.open(path, std::ios::binary);
+    if(!file.is_open())
+    {
+        return 0;
+    }
+    char magic[sizeof(kMagic)];
+    std::vector<uint32_t> version;
+    std::vector<uint64_t> count;
+    if(!file.read(magic, sizeof(magic)) || memcmp(magic, kMagic, sizeof(kMagic)) != 0
+        || !read_column(file, version, 1) || version[0] != kVersion || !read_column(file, count, 1))
+    {
+        return 0;
+    }
+    //Check the size before allocating columns for a corrupt count.
+    std::streamoff start = file.tellg();
+    file.seekg(0, std::ios::end);
+    std::streamoff end = file.tellg();
+    file.seekg(start);
+    uint64_t bytes = static_cast<uint64_t>(end - start);
+    if(bytes % kEntryBytes != 0 || count[0] != bytes / kEntryBytes)
+    {
+        return 0;
+    }
+    size_t n = static_cast<size_t>(count[0]);
+    if(!read_column(file, m_parent_a, n) || !read_column(file, m_parent_b, n)
+        || !read_column(file, m_op, n) || !read_column(file, m_generation, n))
+    {
+        clear();
+        return 0;
+    }
+    //Parent order is what the queries depend on.
+    for(size_t i = 0; i < n; i++)
+    {
+        if((m_parent_a[i] != kNone && m_parent_a[i] >= i) || (m_parent_b[i] != kNone && m_parent_b[i] >= i))
+        {
+            clear();
+            return 0;
+        }
+    }
+    return 1;
+}
@@ -0,0 +1,119 @@
+#ifndef fn_LINEAGE_H
+#define fn_LINEAGE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+/**
+ * How an individual in a LineageLog was produced.
+ */
+enum LineageOp : uint8_t
+{
+    LINEAGE_FOUNDER,
+    LINEAGE_CROSSOVER,
+    LINEAGE_MUTATION,
+    LINEAGE_CLONE,
+    LINEAGE_MIGRATION
+};
+
+/**
+ * Append-only pedigree of a run. Every individual gets the next id when it
+ * is recorded, and its parents, operator and generation go into one column
+ * each, so an entry costs 21 bytes with no per-genome allocation. Callers
+ * keep the id next to the genome, e.g. in a vector indexed like the
+ * population.
+ *
+ * Parents are always recorded before their children, so every parent id is
+ * smaller than its child's. Queries rely on that to walk the log in one
+ * direction without a visited set.
+ *
+ * Appends must come from one thread at a time; queries may run concurrently
+ * with each other.
+ */
+class LineageLog
+{
+public:
+    static const uint64_t kNone = UINT64_MAX;
+
+private:
+    std::vector<uint64_t> m_parent_a;
+    std::vector<uint64_t> m_parent_b;
+    std::vector<uint8_t> m_op;
+    std::vector<uint32_t> m_generation;
+
+public:
+    /**
+     * Records an individual and returns its id. Unused parents are kNone.
+     * Returns kNone without recording if a parent id is not in the log.
+     */
+    uint64_t record(uint64_t parent_a, uint64_t parent_b, LineageOp op, uint32_t generation);
+
+    uint64_t founder(uint32_t generation)
+    {
+        return record(kNone, kNone, LINEAGE_FOUNDER, generation);
+    }
+
+    size_t size() const
+    {
+        return m_op.size();
+    }
+
+    uint64_t parent_a(uint64_t id) const
+    {
+        return m_parent_a[id];
+    }
+
+    uint64_t parent_b(uint64_t id) const
+    {
+        return m_parent_b[id];
+    }
+
+    LineageOp op(uint64_t id) const
+    {
+        return static_cast<LineageOp>(m_op[id]);
+    }
+
+    uint32_t generation(uint64_t id) const
+    {
+        return m_generation[id];
+    }
+
+    /**
+     * Every ancestor of id, ascending, not including id itself. Empty if id
+     * is not in the log.
+     */
+    std::vector<uint64_t> ancestors(uint64_t id) const;
+
+    /**
+     * Every descendant of id, ascending, not including id itself. Empty if
+     * id is not in the log.
+     */
+    std::vector<uint64_t> descendants(uint64_t id) const;
+
+    /**
+     * Expected share of the genome of the individuals in generation that
+     * traces back to id, averaged over that generation. A crossover child
+     * inherits half from each parent; other operators pass the whole share
+     * on. Returns 0 if the generation has no individuals or id is not in
+     * the log.
+     */
+    double contribution(uint64_t id, uint32_t generation) const;
+
+    void clear();
+
+    /**
+     * Writes the log next to a population file. Columns are stored little
+     * endian. Returns 1 on success, 0 on failure.
+     */
+    int save(const std::string& path) const;
+
+    /**
+     * Replaces the log with the one at path. Returns 1 on success, 0 on
+     * failure, in which case the log is left empty.
+     */
+    int load(const std::string& path);
+};
+
+#endif
@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "numa.h"
+
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#endif
+
+namespace
+{
+
+//Parses a sysfs list such as "0-3,8-11", as used for CPUs and nodes.
+std::vector<unsigned int> parse_list(const std::string& list)
+{
+    std::vector<unsigned int> values;
+    std::istringstream in(list);
+    std::string range;
+    while(std::getline(in, range, ','))
+    {
+        if(range.empty() || range[0] == '\n')
+        {
+            continue;
+        }
+        size_t dash = range.find('-');
+        unsigned int lo = std::stoul(range.substr(0, dash));
+        unsigned int hi = dash == std::string::npos ? lo : std::stoul(range.substr(dash + 1));
+        for(unsigned int c = lo; c <= hi; c++)
+        {
+            values.push_back(c);
+        }
+    }
+    return values;
+}
+
+//First line of a sysfs file, or false if it cannot be read.
+bool read_line(const std::string& path, std::string& line)
+{
+    std::ifstream file(path);
+    if(!file.is_open())
+    {
+        return false;
+    }
+    std::getline(file, line);
+    return true;
+}
+
+} //namespace
+
+NumaTopology::NumaTopology(const std::string& dir)
+{
+    //Node ids need not be contiguous, so walk the listed ones.
+    std::string nodes;
+    if(read_line(dir + "/online", nodes) || read_line(dir + "/possible", nodes))
+    {
+        for(unsigned int id : parse_list(nodes))
+        {
+            std::string list;
+            if(!read_line(dir + "/node" + std::to_string(id) + "/cpulist", list))
+            {
+                continue;
+            }
+            std::vector<unsigned int> cpus = parse_list(list);
+            if(!cpus.empty())
+            {
+                m_ids.push_back(id);
+                m_cpus.push_back(cpus);
+            }
+        }
+    }
+    if(m_cpus.empty())
+    {
+        std::vector<unsigned int> all;
+        unsigned int n = std::max(1u, std::thread::hardware_concurrency());
+        for(unsigned int c = 0; c < n; c++)
+        {
+            all.push_back(c);
+        }
+        m_ids.push_back(0);
+        m_cpus.push_back(all);
+    }
+}
+
+const NumaTopology& NumaTopology::get()
+{
+    static NumaTopology topology("/sys/devices/system/node");
+    return topology;
+}
+
+bool numa_bind_thread(unsigned int node, const NumaTopology& topology)
+{
+#ifdef __linux__
+    if(node >= topology.nodes() || topology.cpus(node).empty())
+    {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for(unsigned int c : topology.cpus(node))
+    {
+        if(c < CPU_SETSIZE)
+        {
+            CPU_SET(c, &set);
+        }
+    }
+    bool ok = sched_setaffinity(0, sizeof(set), &set) == 0;
+    if(topology.nodes() > 1)
+    {
+        const unsigned int kMaxNode = 1024;
+        const unsigned int kWordBits = 8 * sizeof(unsigned long);
+        unsigned int id = topology.id(node);
+        if(id >= kMaxNode)
+        {
+            return false;
+        }
+        unsigned long mask[kMaxNode / kWordBits] = {0};
+        mask[id / kWordBits] |= 1ul << (id % kWordBits);
+        ok = syscall(SYS_set_mempolicy, MPOL_PREFERRED, mask, kMaxNode) == 0 && ok;
+    }
+    return ok;
+#else
+    return node < topology.nodes();
+#endif
+}
+
+NumaWorkerPool::NumaWorkerPool(unsigned int workers, const NumaTopology& topology) :
+    m_topology(topology),
+    m_round(0),
+    m_pending(0),
+    m_stop(false)
+{
+    if(workers == 0)
+    {
+        for(unsigned int n = 0; n < m_topology.nodes(); n++)
+        {
+            workers += static_cast<unsigned int>(m_topology.cpus(n).size());
+        }
+    }
+    //Round-robin over nodes so small pools still touch every node.
+    for(unsigned int w = 0; w < workers; w++)
+    {
+        m_nodes.push_back(w % m_topology.nodes());
+    }
+    for(unsigned int w = 0; w < workers; w++)
+    {
+        m_threads.emplace_back(&NumaWorkerPool::work, this, w);
+    }
+}
+
+NumaWorkerPool::~NumaWorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for(std::thread& t : m_threads)
+    {
+        t.join();
+    }
+}
+
+unsigned int NumaWorkerPool::workers_on(unsigned int node) const
+{
+    unsigned int n = 0;
+    for(unsigned int w : m_nodes)
+    {
+        n += w == node;
+    }
+    return n;
+}
+
+unsigned int NumaWorkerPool::rank_on_node(unsigned int worker) const
+{
+    unsigned int rank = 0;
+    for(unsigned int w = 0; w < worker; w++)
+    {
+        rank += m_nodes[w] == m_nodes[worker];
+    }
+    return rank;
+}
+
+void NumaWorkerPool::work(unsigned int worker)
+{
+    unsigned int node = m_nodes[worker];
+    numa_bind_thread(node, m_topology);
+    uint_fast64_t seen = 0;
+    for(;;)
+    {
+        std::function<void(unsigned int, unsigned int)> task;
+        {
+            std::unique_lock<std::mutex> guard(m_lock);
+            m_wake.wait(guard, [this, seen]() { return m_stop || m_round != seen; });
+            if(m_stop)
+            {
+                return;
+            }
+            seen = m_round;
+            task = m_task;
+        }
+        task(worker, node);
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            if(--m_pending == 0)
+            {
+                m_done.notify_one();
+            }
+        }
+    }
+}
+
+void NumaWorkerPool::run(const std::function<void(unsigned int, unsigned int)>& task)
+{
+    std::unique_lock<std::mutex> guard(m_lock);
+    m_task = task;
+    m_pending = size();
+    m_round++;
+    m_wake.notify_all();
+    m_done.wait(guard, [this]() { return m_pending == 0; });
+}
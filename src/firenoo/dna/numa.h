@@ -0,0 +1,200 @@
+#ifndef fn_NUMA_H
+#define fn_NUMA_H
+
+#include <stdint.h>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "population.h"
+
+//NUMA placement for populations. Workers are pinned to the CPUs of one node
+//and given a preferred memory policy for that node, so every genome a worker
+//allocates (CharDna buffers and population chunks) comes from local memory.
+//Genomes only cross nodes when selection asks for a migrate().
+//
+//Uses sysfs and raw syscalls on Linux, without libnuma. Elsewhere, or on a
+//single-node machine, everything behaves as one node.
+
+/**
+ * Node to CPU map read from sysfs. Nodes are numbered 0..nodes()-1 here;
+ * id() gives the kernel's node id, which may have gaps (offline or
+ * hot-plugged nodes). Nodes without CPUs are left out, since no worker can
+ * run on them.
+ */
+class NumaTopology
+{
+private:
+    std::vector<unsigned int> m_ids;
+    std::vector<std::vector<unsigned int>> m_cpus;
+
+public:
+    /**
+     * Reads the online nodes listed in dir/online (or dir/possible) and the
+     * cpulist of each. If none can be read, the machine is one node with
+     * every CPU.
+     */
+    explicit NumaTopology(const std::string& dir);
+
+    //Topology of this machine, from /sys/devices/system/node.
+    static const NumaTopology& get();
+
+    unsigned int nodes() const
+    {
+        return static_cast<unsigned int>(m_cpus.size());
+    }
+
+    unsigned int id(unsigned int node) const
+    {
+        return m_ids[node];
+    }
+
+    const std::vector<unsigned int>& cpus(unsigned int node) const
+    {
+        return m_cpus[node];
+    }
+};
+
+/**
+ * Pins the calling thread to the CPUs of node and prefers that node for its
+ * future allocations. Returns false if either step failed; the thread is
+ * still usable.
+ */
+bool numa_bind_thread(unsigned int node, const NumaTopology& topology = NumaTopology::get());
+
+/**
+ * Persistent pool of worker threads, spread round-robin over nodes and bound
+ * with numa_bind_thread(). run() executes a task on every worker and waits.
+ */
+class NumaWorkerPool
+{
+private:
+    const NumaTopology& m_topology;
+    std::vector<std::thread> m_threads;
+    std::vector<unsigned int> m_nodes;
+    std::function<void(unsigned int, unsigned int)> m_task;
+    std::mutex m_lock;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    uint_fast64_t m_round;
+    unsigned int m_pending;
+    bool m_stop;
+
+    void work(unsigned int worker);
+
+public:
+    //workers == 0 uses one worker per CPU. topology must outlive the pool.
+    explicit NumaWorkerPool(unsigned int workers = 0, const NumaTopology& topology = NumaTopology::get());
+    ~NumaWorkerPool();
+
+    NumaWorkerPool(const NumaWorkerPool&) = delete;
+    NumaWorkerPool& operator=(const NumaWorkerPool&) = delete;
+
+    unsigned int size() const
+    {
+        return static_cast<unsigned int>(m_nodes.size());
+    }
+
+    unsigned int node_of(unsigned int worker) const
+    {
+        return m_nodes[worker];
+    }
+
+    //Number of workers on node.
+    unsigned int workers_on(unsigned int node) const;
+
+    //Rank of worker among the workers of its node.
+    unsigned int rank_on_node(unsigned int worker) const;
+
+    /**
+     * Calls task(worker, node) on every worker and returns when all finish.
+     * Call from one thread at a time.
+     */
+    void run(const std::function<void(unsigned int, unsigned int)>& task);
+};
+
+//Location of a genome in a NumaPopulation.
+struct NumaIndex
+{
+    unsigned int node;
+    uint_fast64_t index;
+};
+
+/**
+ * One ConcurrentPopulation shard per node. Workers breed into and evaluate
+ * the shard of their own node.
+ */
+class NumaPopulation
+{
+private:
+    std::vector<std::unique_ptr<ConcurrentPopulation>> m_shards;
+
+public:
+    explicit NumaPopulation(unsigned int nodes = NumaTopology::get().nodes())
+    {
+        for(unsigned int n = 0; n < nodes; n++)
+        {
+            m_shards.emplace_back(new ConcurrentPopulation());
+        }
+    }
+
+    unsigned int nodes() const
+    {
+        return static_cast<unsigned int>(m_shards.size());
+    }
+
+    ConcurrentPopulation& shard(unsigned int node)
+    {
+        return *m_shards[node];
+    }
+
+    CharDna& operator[](const NumaIndex& at)
+    {
+        return (*m_shards[at.node])[at.index];
+    }
+
+    NumaIndex insert(unsigned int node, CharDna&& dna)
+    {
+        NumaIndex at = {node, m_shards[node]->insert(std::move(dna))};
+        return at;
+    }
+
+    /**
+     * Copies a selected genome into the shard of node. Call from a worker on
+     * that node so the copy is allocated locally. Returns the new location,
+     * or from unchanged if it is already on node.
+     */
+    NumaIndex migrate(const NumaIndex& from, unsigned int node)
+    {
+        if(from.node == node)
+        {
+            return from;
+        }
+        CharDna copy((*m_shards[from.node])[from.index]);
+        return insert(node, std::move(copy));
+    }
+
+    uint_fast64_t size() const
+    {
+        uint_fast64_t n = 0;
+        for(const std::unique_ptr<ConcurrentPopulation>& s : m_shards)
+        {
+            n += s->size();
+        }
+        return n;
+    }
+
+    void clear()
+    {
+        for(std::unique_ptr<ConcurrentPopulation>& s : m_shards)
+        {
+            s->clear();
+        }
+    }
+};
+
+#endif
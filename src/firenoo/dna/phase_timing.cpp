@@ -0,0 +1,204 @@
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "phase_timing.h"
+
+void LatencyHistogram::clear()
+{
+    for(unsigned int i = 0; i < kBuckets; i++)
+    {
+        m_counts[i].store(0, std::memory_order_relaxed);
+    }
+    m_total.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+    for(unsigned int i = 0; i < kBuckets; i++)
+    {
+        m_counts[i].fetch_add(other.m_counts[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    m_total.fetch_add(other.m_total.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    m_sum.fetch_add(other.m_sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    uint_fast64_t m = other.m_max.load(std::memory_order_relaxed);
+    if(m > m_max.load(std::memory_order_relaxed))
+    {
+        m_max.store(m, std::memory_order_relaxed);
+    }
+}
+
+double LatencyHistogram::mean() const
+{
+    uint_fast64_t n = count();
+    return n == 0 ? 0.0 : static_cast<double>(m_sum.load(std::memory_order_relaxed)) / n;
+}
+
+uint_fast64_t LatencyHistogram::percentile(double q) const
+{
+    uint_fast64_t n = count();
+    if(n == 0)
+    {
+        return 0;
+    }
+    uint_fast64_t rank = static_cast<uint_fast64_t>(q * n);
+    if(rank >= n)
+    {
+        rank = n - 1;
+    }
+    uint_fast64_t seen = 0;
+    for(unsigned int i = 0; i < kBuckets; i++)
+    {
+        seen += m_counts[i].load(std::memory_order_relaxed);
+        if(seen > rank)
+        {
+            uint_fast64_t low = bucket_low(i);
+            uint_fast64_t high = i + 1 < kBuckets ? bucket_low(i + 1) : low;
+            uint_fast64_t mid = low + (high - low) / 2;
+            return mid < max() ? mid : max();
+        }
+    }
+    return max();
+}
+
+namespace
+{
+
+std::mutex g_registry_lock;
+
+//Sets of the threads that are still running.
+std::vector<std::unique_ptr<PhaseTimings::ThreadSet>>& registry()
+{
+    static std::vector<std::unique_ptr<PhaseTimings::ThreadSet>> sets;
+    return sets;
+}
+
+//Everything recorded by threads that have exited.
+PhaseTimings::ThreadSet& retired()
+{
+    static PhaseTimings::ThreadSet set;
+    return set;
+}
+
+} //namespace
+
+double PhaseTimings::ns_per_tick()
+{
+    static const double ratio = []() {
+#if defined(__x86_64__) || defined(__i386__)
+        typedef std::chrono::steady_clock clock;
+        clock::time_point t0 = clock::now();
+        uint_fast64_t c0 = dna_ticks();
+        while(clock::now() - t0 < std::chrono::milliseconds(10))
+        {
+        }
+        uint_fast64_t c1 = dna_ticks();
+        double ns = std::chrono::duration<double, std::nano>(clock::now() - t0).count();
+        return c1 > c0 ? ns / static_cast<double>(c1 - c0) : 1.0;
+#else
+        return 1.0;
+#endif
+    }();
+    return ratio;
+}
+
+struct PhaseTimings::Owner
+{
+    ThreadSet* set = nullptr;
+
+    ~Owner()
+    {
+        if(set != nullptr)
+        {
+            t_set = nullptr;
+            retire_thread(set);
+        }
+    }
+};
+
+PhaseTimings::ThreadSet* PhaseTimings::register_thread()
+{
+    static thread_local Owner owner;
+    std::unique_ptr<ThreadSet> set(new ThreadSet());
+    set->ns_per_tick = ns_per_tick();
+    t_set = set.get();
+    owner.set = t_set;
+    std::lock_guard<std::mutex> guard(g_registry_lock);
+    registry().push_back(std::move(set));
+    return t_set;
+}
+
+void PhaseTimings::retire_thread(ThreadSet* set)
+{
+    std::lock_guard<std::mutex> guard(g_registry_lock);
+    std::vector<std::unique_ptr<ThreadSet>>& sets = registry();
+    for(size_t i = 0; i < sets.size(); i++)
+    {
+        if(sets[i].get() == set)
+        {
+            for(unsigned int p = 0; p < PHASE_COUNT; p++)
+            {
+                retired().hist[p].merge(set->hist[p]);
+            }
+            sets[i] = std::move(sets.back());
+            sets.pop_back();
+            return;
+        }
+    }
+}
+
+const char* PhaseTimings::name(DnaPhase phase)
+{
+    switch(phase)
+    {
+        case PHASE_DECODE: return "decode";
+        case PHASE_FITNESS: return "fitness";
+        case PHASE_SELECTION: return "selection";
+        case PHASE_CROSSOVER: return "crossover";
+        case PHASE_MUTATION: return "mutation";
+        case PHASE_SERIALIZE: return "serialize";
+        default: return "unknown";
+    }
+}
+
+LatencyHistogram PhaseTimings::merged(DnaPhase phase)
+{
+    LatencyHistogram result;
+    std::lock_guard<std::mutex> guard(g_registry_lock);
+    result.merge(retired().hist[phase]);
+    for(const std::unique_ptr<ThreadSet>& set : registry())
+    {
+        result.merge(set->hist[phase]);
+    }
+    return result;
+}
+
+void PhaseTimings::reset()
+{
+    std::lock_guard<std::mutex> guard(g_registry_lock);
+    for(unsigned int p = 0; p < PHASE_COUNT; p++)
+    {
+        retired().hist[p].clear();
+    }
+    for(const std::unique_ptr<ThreadSet>& set : registry())
+    {
+        for(unsigned int p = 0; p < PHASE_COUNT; p++)
+        {
+            set->hist[p].clear();
+        }
+    }
+}
+
+void PhaseTimings::report(std::ostream& os)
+{
+    for(unsigned int p = 0; p < PHASE_COUNT; p++)
+    {
+        DnaPhase phase = static_cast<DnaPhase>(p);
+        LatencyHistogram h = merged(phase);
+        os << name(phase) << " count=" << h.count() << " mean=" << h.mean()
+           << " p50=" << h.percentile(0.5) << " p99=" << h.percentile(0.99)
+           << " max=" << h.max() << '\n';
+    }
+}
@@ -0,0 +1,223 @@
+#ifndef fn_PHASE_TIMING_H
+#define fn_PHASE_TIMING_H
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <ostream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+//Per-phase latency histograms for a generation. Wrap a phase in
+//fn_PHASE_SCOPE(PHASE_x); the elapsed time is recorded into this thread's
+//histogram for that phase. Define fn_DNA_TIMING to enable it; otherwise the
+//macro expands to nothing.
+
+enum DnaPhase
+{
+    PHASE_DECODE,
+    PHASE_FITNESS,
+    PHASE_SELECTION,
+    PHASE_CROSSOVER,
+    PHASE_MUTATION,
+    PHASE_SERIALIZE,
+    PHASE_COUNT
+};
+
+/**
+ * Log-linear histogram of nanosecond values, in the style of HDR histograms.
+ * Values below 16 get exact buckets; above that every power of two is split
+ * into 16 sub-buckets, so a reported value is within 1/16 of the real one.
+ * Counts are relaxed atomics: one thread records, any thread may read.
+ */
+class LatencyHistogram
+{
+public:
+    static const unsigned int kSubBits = 4;
+    static const unsigned int kSub = 1u << kSubBits;
+    static const unsigned int kBuckets = (64 - kSubBits + 1) * kSub;
+
+private:
+    std::atomic<uint_fast64_t> m_counts[kBuckets];
+    std::atomic<uint_fast64_t> m_total;
+    std::atomic<uint_fast64_t> m_sum;
+    std::atomic<uint_fast64_t> m_max;
+
+    static unsigned int bucket(uint_fast64_t v)
+    {
+        if(v < kSub)
+        {
+            return static_cast<unsigned int>(v);
+        }
+        unsigned int top = 63 - __builtin_clzll(v);
+        unsigned int shift = top - kSubBits;
+        return (shift + 1) * kSub + static_cast<unsigned int>((v >> shift) & (kSub - 1));
+    }
+
+    //Bumps a counter owned by the recording thread; no RMW needed.
+    static void bump(std::atomic<uint_fast64_t>& c, uint_fast64_t by)
+    {
+        c.store(c.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+public:
+    LatencyHistogram()
+    {
+        clear();
+    }
+
+    LatencyHistogram(const LatencyHistogram& other)
+    {
+        clear();
+        merge(other);
+    }
+
+    LatencyHistogram& operator=(const LatencyHistogram& other)
+    {
+        if(this != &other)
+        {
+            clear();
+            merge(other);
+        }
+        return *this;
+    }
+
+    void record(uint_fast64_t ns)
+    {
+        bump(m_counts[bucket(ns)], 1);
+        bump(m_total, 1);
+        bump(m_sum, ns);
+        if(ns > m_max.load(std::memory_order_relaxed))
+        {
+            m_max.store(ns, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Lowest value that falls in the given bucket.
+     */
+    static uint_fast64_t bucket_low(unsigned int index)
+    {
+        if(index < kSub)
+        {
+            return index;
+        }
+        unsigned int shift = index / kSub - 1;
+        return static_cast<uint_fast64_t>(kSub + index % kSub) << shift;
+    }
+
+    void clear();
+    void merge(const LatencyHistogram& other);
+
+    uint_fast64_t count() const
+    {
+        return m_total.load(std::memory_order_relaxed);
+    }
+
+    uint_fast64_t max() const
+    {
+        return m_max.load(std::memory_order_relaxed);
+    }
+
+    double mean() const;
+
+    /**
+     * Value at quantile q (0..1), reported as the midpoint of its bucket and
+     * capped at the recorded maximum. Returns 0 if nothing was recorded.
+     */
+    uint_fast64_t percentile(double q) const;
+};
+
+/**
+ * Raw timestamp: the TSC where available, otherwise steady_clock nanoseconds.
+ * Convert differences with PhaseTimings::ns_per_tick().
+ */
+inline uint_fast64_t dna_ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint_fast64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+/**
+ * Histograms for every phase, one set per recording thread. Threads register
+ * on first use. When a thread exits, its set is folded into one shared set
+ * for retired threads and freed, so short-lived worker threads do not grow
+ * memory. merged() folds the live and retired sets together.
+ */
+class PhaseTimings
+{
+public:
+    struct ThreadSet
+    {
+        double ns_per_tick;
+        LatencyHistogram hist[PHASE_COUNT];
+    };
+
+private:
+    //Retires the thread's set when the thread exits.
+    struct Owner;
+
+    static inline thread_local ThreadSet* t_set = nullptr;
+    static ThreadSet* register_thread();
+    static void retire_thread(ThreadSet* set);
+
+public:
+    static void record_ticks(DnaPhase phase, uint_fast64_t ticks)
+    {
+        ThreadSet* set = t_set;
+        if(set == nullptr)
+        {
+            set = register_thread();
+        }
+        set->hist[phase].record(static_cast<uint_fast64_t>(ticks * set->ns_per_tick));
+    }
+
+    //Calibrated once against steady_clock.
+    static double ns_per_tick();
+
+    static const char* name(DnaPhase phase);
+
+    static LatencyHistogram merged(DnaPhase phase);
+
+    //Clears the histograms of every registered thread. Samples recorded
+    //while this runs may survive it.
+    static void reset();
+
+    //One line per phase: name, count, mean, p50, p99, max (ns).
+    static void report(std::ostream& os);
+};
+
+/**
+ * Records the time between construction and destruction to a phase.
+ */
+class PhaseScope
+{
+private:
+    DnaPhase m_phase;
+    uint_fast64_t m_start;
+public:
+    explicit PhaseScope(DnaPhase phase) :
+        m_phase(phase),
+        m_start(dna_ticks())
+    {
+    }
+
+    ~PhaseScope()
+    {
+        PhaseTimings::record_ticks(m_phase, dna_ticks() - m_start);
+    }
+};
+
+#ifdef fn_DNA_TIMING
+#define fn_PHASE_SCOPE(phase) PhaseScope fn_phase_scope(phase)
+#else
+#define fn_PHASE_SCOPE(phase)
+#endif
+
+#endif
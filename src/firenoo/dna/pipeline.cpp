@@ -0,0 +1,146 @@
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "bounded_queue.h"
+#include "pipeline.h"
+
+namespace
+{
+
+typedef BoundedQueue<GenomeBatch*> BatchQueue;
+
+const unsigned int kStages = 4;
+
+struct Stage
+{
+    const std::function<void(GenomeBatch&)>* fn;
+    BatchQueue* in;
+    BatchQueue* out;
+    std::atomic<unsigned int> live;
+};
+
+void run_stage(Stage& stage)
+{
+    GenomeBatch* batch = nullptr;
+    while(stage.in->pop(batch))
+    {
+        if(*stage.fn)
+        {
+            (*stage.fn)(*batch);
+        }
+        stage.out->push(batch);
+    }
+    //The last thread out closes the next queue.
+    if(stage.live.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        stage.out->close();
+    }
+}
+
+} //namespace
+
+/**
+ * Stage threads, the queues between them and the batches that travel
+ * through, kept for the life of the pipeline.
+ */
+struct GenerationPipeline::Workers
+{
+    BatchQueue queues[kStages + 1];
+    //Batches not currently in the pipeline.
+    BatchQueue idle;
+    std::vector<std::unique_ptr<GenomeBatch>> pool;
+    Stage stages[kStages];
+    std::vector<std::thread> threads;
+
+    Workers(uint_fast64_t depth, uint_fast64_t in_flight) :
+        queues{BatchQueue(depth), BatchQueue(depth), BatchQueue(depth), BatchQueue(depth), BatchQueue(in_flight)},
+        idle(in_flight)
+    {
+        for(uint_fast64_t i = 0; i < in_flight; i++)
+        {
+            pool.emplace_back(new GenomeBatch());
+            idle.push(pool.back().get());
+        }
+    }
+};
+
+GenerationPipeline::GenerationPipeline(const PipelineStages& stages, uint_fast32_t batch_size,
+    uint_fast32_t queue_depth) :
+    m_stages(stages),
+    m_batch_size(batch_size == 0 ? 1 : batch_size),
+    m_queue_depth(queue_depth == 0 ? 1 : queue_depth)
+{
+    const std::function<void(GenomeBatch&)>* fns[kStages] = {
+        &m_stages.decode, &m_stages.fitness, &m_stages.select, &m_stages.breed
+    };
+    unsigned int threads[kStages] = {
+        m_stages.decode_threads, m_stages.fitness_threads, m_stages.select_threads, m_stages.breed_threads
+    };
+    //Every batch in flight sits in a queue or a stage, which bounds memory.
+    uint_fast64_t in_flight = static_cast<uint_fast64_t>(m_queue_depth) * 5;
+    for(unsigned int s = 0; s < kStages; s++)
+    {
+        threads[s] = threads[s] == 0 ? 1 : threads[s];
+        in_flight += threads[s];
+    }
+    m_workers.reset(new Workers(m_queue_depth, in_flight));
+    for(unsigned int s = 0; s < kStages; s++)
+    {
+        Stage& stage = m_workers->stages[s];
+        stage.fn = fns[s];
+        stage.in = &m_workers->queues[s];
+        stage.out = &m_workers->queues[s + 1];
+        stage.live.store(threads[s], std::memory_order_relaxed);
+        for(unsigned int t = 0; t < threads[s]; t++)
+        {
+            m_workers->threads.emplace_back(run_stage, std::ref(stage));
+        }
+    }
+}
+
+GenerationPipeline::~GenerationPipeline()
+{
+    //Closing the first queue drains every stage in turn.
+    m_workers->queues[0].close();
+    for(std::thread& t : m_workers->threads)
+    {
+        t.join();
+    }
+}
+
+void GenerationPipeline::run(uint_fast64_t genomes)
+{
+    uint_fast64_t batches = (genomes + m_batch_size - 1) / m_batch_size;
+    BatchQueue& first = m_workers->queues[0];
+    BatchQueue& done = m_workers->queues[kStages];
+    BatchQueue& idle = m_workers->idle;
+    //Feed batches, recycling the ones that come out of the last stage.
+    uint_fast64_t next = 0;
+    uint_fast64_t finished = 0;
+    while(next < batches)
+    {
+        GenomeBatch* batch = nullptr;
+        if(!idle.try_pop(batch))
+        {
+            if(!done.pop(batch))
+            {
+                return;
+            }
+            finished++;
+        }
+        batch->first = next * m_batch_size;
+        uint_fast64_t left = genomes - batch->first;
+        batch->count = static_cast<uint_fast32_t>(left < m_batch_size ? left : m_batch_size);
+        batch->fitness.assign(batch->count, 0.0);
+        batch->selected.clear();
+        first.push(batch);
+        next++;
+    }
+    GenomeBatch* batch = nullptr;
+    while(finished < batches && done.pop(batch))
+    {
+        idle.push(batch);
+        finished++;
+    }
+}
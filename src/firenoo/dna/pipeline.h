@@ -0,0 +1,83 @@
+#ifndef fn_PIPELINE_H
+#define fn_PIPELINE_H
+
+#include <stdint.h>
+#include <functional>
+#include <memory>
+#include <vector>
+
+//Pipelined generation: decode, fitness, selection and breeding run as
+//concurrent stages connected by bounded lock-free queues. Batches of genome
+//indices flow through them, so a slow fitness call on one batch overlaps
+//with decoding the next and breeding the previous one.
+//
+//Selection only sees the batches that have reached it, not the whole
+//population, so it suits steady-state or tournament selection.
+//Stage functions do their own fn_PHASE_SCOPE timing if they want it.
+
+/**
+ * A contiguous run of genome indices plus per-stage scratch. fitness is
+ * sized to count before the first stage runs; stages may fill selected with
+ * whatever parent indices the breed stage expects.
+ */
+struct GenomeBatch
+{
+    uint_fast64_t first;
+    uint_fast32_t count;
+    std::vector<double> fitness;
+    std::vector<uint_fast64_t> selected;
+};
+
+/**
+ * Work for each stage and how many threads run it. A stage with no function
+ * passes batches through unchanged. Functions are called concurrently on
+ * different batches.
+ */
+struct PipelineStages
+{
+    std::function<void(GenomeBatch&)> decode;
+    std::function<void(GenomeBatch&)> fitness;
+    std::function<void(GenomeBatch&)> select;
+    std::function<void(GenomeBatch&)> breed;
+    unsigned int decode_threads = 1;
+    unsigned int fitness_threads = 1;
+    unsigned int select_threads = 1;
+    unsigned int breed_threads = 1;
+};
+
+/**
+ * Stage threads are started by the constructor and live until the pipeline
+ * is destroyed, so one pipeline can run every generation. A stage with
+ * nothing to do sleeps rather than spins.
+ */
+class GenerationPipeline
+{
+private:
+    struct Workers;
+
+    PipelineStages m_stages;
+    uint_fast32_t m_batch_size;
+    uint_fast32_t m_queue_depth;
+    std::unique_ptr<Workers> m_workers;
+
+public:
+    /**
+     * batch_size genomes travel together; each queue between stages holds at
+     * most queue_depth batches.
+     */
+    GenerationPipeline(const PipelineStages& stages, uint_fast32_t batch_size = 256,
+        uint_fast32_t queue_depth = 8);
+    GenerationPipeline(const GenerationPipeline&) = delete;
+    GenerationPipeline& operator=(const GenerationPipeline&) = delete;
+
+    //Lets the stages finish and joins their threads.
+    ~GenerationPipeline();
+
+    /**
+     * Pushes genomes [0, genomes) through every stage and returns when the
+     * last batch has been bred. One run at a time.
+     */
+    void run(uint_fast64_t genomes);
+};
+
+#endif
@@ -0,0 +1,199 @@
+#ifndef fn_POPULATION_H
+#define fn_POPULATION_H
+
+#include <assert.h>
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "char_dna.h"
+
+/**
+ * Population of CharDna genomes that many threads can insert into at once.
+ *
+ * Indices are handed out by one atomic counter, so inserting never takes a
+ * lock. A thread that breeds a batch can reserve() a contiguous range once
+ * and fill it with emplace_at(). Slots live in fixed-size chunks that are
+ * never moved, so an index and the genome's address stay valid until clear().
+ *
+ * A slot is readable once ready(index) is true. After every inserting thread
+ * has been joined, all reserved slots are ready.
+ */
+class ConcurrentPopulation
+{
+public:
+    static const unsigned int kChunkBits = 12;
+    static const uint_fast64_t kChunkSize = 1ull << kChunkBits;
+    static const uint_fast64_t kMaxChunks = 1ull << 16;
+    //Returned by insert()/reserve() when the population is full.
+    static const uint_fast64_t kNoIndex = UINT64_MAX;
+
+private:
+    struct Slot
+    {
+        alignas(CharDna) unsigned char storage[sizeof(CharDna)];
+        std::atomic<bool> ready;
+
+        CharDna* dna()
+        {
+            return std::launder(reinterpret_cast<CharDna*>(storage));
+        }
+    };
+
+    std::unique_ptr<std::atomic<Slot*>[]> m_chunks;
+    std::atomic<uint_fast64_t> m_next;
+
+    Slot* chunk(uint_fast64_t c)
+    {
+        Slot* p = m_chunks[c].load(std::memory_order_acquire);
+        if(p == nullptr)
+        {
+            Slot* fresh = new Slot[kChunkSize];
+            for(uint_fast64_t i = 0; i < kChunkSize; i++)
+            {
+                fresh[i].ready.store(false, std::memory_order_relaxed);
+            }
+            if(m_chunks[c].compare_exchange_strong(p, fresh, std::memory_order_acq_rel))
+            {
+                p = fresh;
+            } else
+            {
+                //Another thread installed the chunk first.
+                delete[] fresh;
+            }
+        }
+        return p;
+    }
+
+    Slot& slot(uint_fast64_t index)
+    {
+        return chunk(index >> kChunkBits)[index & (kChunkSize - 1)];
+    }
+
+    const Slot& slot(uint_fast64_t index) const
+    {
+        return m_chunks[index >> kChunkBits].load(std::memory_order_acquire)[index & (kChunkSize - 1)];
+    }
+
+public:
+    ConcurrentPopulation() :
+        m_chunks(new std::atomic<Slot*>[kMaxChunks]),
+        m_next(0)
+    {
+        for(uint_fast64_t c = 0; c < kMaxChunks; c++)
+        {
+            m_chunks[c].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ~ConcurrentPopulation()
+    {
+        clear();
+    }
+
+    ConcurrentPopulation(const ConcurrentPopulation&) = delete;
+    ConcurrentPopulation& operator=(const ConcurrentPopulation&) = delete;
+
+    /**
+     * Reserves count consecutive indices and returns the first. Each must be
+     * filled with emplace_at(). Returns kNoIndex, reserving nothing, if the
+     * range does not fit. Thread-safe.
+     */
+    uint_fast64_t reserve(uint_fast64_t count)
+    {
+        uint_fast64_t first = m_next.load(std::memory_order_relaxed);
+        do
+        {
+            if(count > kMaxChunks * kChunkSize - first)
+            {
+                return kNoIndex;
+            }
+        } while(!m_next.compare_exchange_weak(first, first + count, std::memory_order_relaxed));
+        return first;
+    }
+
+    /**
+     * Moves a genome into a reserved slot that has not been filled yet.
+     * Thread-safe for distinct indices.
+     */
+    void emplace_at(uint_fast64_t index, CharDna&& dna)
+    {
+        Slot& s = slot(index);
+        assert(!s.ready.load(std::memory_order_relaxed));
+        new (s.storage) CharDna(std::move(dna));
+        s.ready.store(true, std::memory_order_release);
+    }
+
+    /**
+     * Moves a genome into the population and returns its index, or kNoIndex
+     * if the population is full (the genome is then left untouched).
+     * Thread-safe.
+     */
+    uint_fast64_t insert(CharDna&& dna)
+    {
+        uint_fast64_t index = reserve(1);
+        if(index != kNoIndex)
+        {
+            emplace_at(index, std::move(dna));
+        }
+        return index;
+    }
+
+    bool ready(uint_fast64_t index) const
+    {
+        if(index >= size())
+        {
+            return false;
+        }
+        const Slot* c = m_chunks[index >> kChunkBits].load(std::memory_order_acquire);
+        return c != nullptr && c[index & (kChunkSize - 1)].ready.load(std::memory_order_acquire);
+    }
+
+    //Number of reserved indices.
+    uint_fast64_t size() const
+    {
+        return m_next.load(std::memory_order_acquire);
+    }
+
+    /**
+     * The genome at a ready index.
+     */
+    CharDna& operator[](uint_fast64_t index)
+    {
+        return *slot(index).dna();
+    }
+
+    const CharDna& operator[](uint_fast64_t index) const
+    {
+        return *const_cast<Slot&>(slot(index)).dna();
+    }
+
+    /**
+     * Destroys every genome and frees the chunks. Not thread-safe.
+     */
+    void clear()
+    {
+        for(uint_fast64_t c = 0; c < kMaxChunks; c++)
+        {
+            Slot* p = m_chunks[c].load(std::memory_order_relaxed);
+            if(p == nullptr)
+            {
+                continue;
+            }
+            for(uint_fast64_t i = 0; i < kChunkSize; i++)
+            {
+                if(p[i].ready.load(std::memory_order_relaxed))
+                {
+                    p[i].dna()->~CharDna();
+                }
+            }
+            delete[] p;
+            m_chunks[c].store(nullptr, std::memory_order_relaxed);
+        }
+        m_next.store(0, std::memory_order_relaxed);
+    }
+};
+
+#endif
@@ -0,0 +1,219 @@
+#include <string.h>
+#include <fstream>
+
+#include "phase_timing.h"
+#include "population_image.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace
+{
+
+const char kMagic[8] = {'T', 'D', 'N', 'A', 'I', 'M', 'G', '\0'};
+const uint32_t kVersion = 1;
+const uint32_t kByteOrder = 0x01020304;
+const uint64_t kAlign = 64;
+const uint64_t kGeneWords = 6;
+
+uint64_t align_up(uint64_t n)
+{
+    return (n + kAlign - 1) & ~(kAlign - 1);
+}
+
+void write_padding(std::ofstream& file, uint64_t from, uint64_t to)
+{
+    static const char zeros[kAlign] = {0};
+    file.write(zeros, static_cast<std::streamsize>(to - from));
+}
+
+//Whether [offset, offset + bytes) lies inside an image of total bytes, with
+//offset aligned for the column's 8-byte words.
+bool in_image(uint64_t offset, uint64_t bytes, uint64_t total)
+{
+    return offset % sizeof(uint64_t) == 0 && offset <= total && bytes <= total - offset;
+}
+
+} //namespace
+
+int write_population_image(const std::string& path, const std::vector<const CharDna*>& genomes,
+    const std::vector<Gene>& genes)
+{
+    fn_PHASE_SCOPE(PHASE_SERIALIZE);
+    uint64_t n = genomes.size();
+    std::vector<uint64_t> offsets(n);
+    uint64_t slab = 0;
+    for(uint64_t i = 0; i < n; i++)
+    {
+        offsets[i] = slab;
+        slab += align_up(CharDna::round_up(genomes[i]->len()));
+    }
+
+    PopulationImageHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version = kVersion;
+    h.byte_order = kByteOrder;
+    h.unit_size = CharDna::unit_size;
+    h.genomes = n;
+    h.genes = genes.size();
+    h.seeds_offset = align_up(sizeof(h));
+    h.lengths_offset = align_up(h.seeds_offset + n * sizeof(uint64_t));
+    h.offsets_offset = align_up(h.lengths_offset + n * sizeof(uint32_t));
+    h.slab_offset = align_up(h.offsets_offset + n * sizeof(uint64_t));
+    h.genes_offset = h.slab_offset + slab;
+    h.total_bytes = h.genes_offset + h.genes * kGeneWords * sizeof(uint64_t);
+
+    std::ofstream file;
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if(!file.is_open())
+    {
+        return 0;
+    }
+    file.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    write_padding(file, sizeof(h), h.seeds_offset);
+    for(const CharDna* d : genomes)
+    {
+        uint64_t seed = d->seed();
+        file.write(reinterpret_cast<const char*>(&seed), sizeof(seed));
+    }
+    write_padding(file, h.seeds_offset + n * sizeof(uint64_t), h.lengths_offset);
+    for(const CharDna* d : genomes)
+    {
+        uint32_t len = d->len();
+        file.write(reinterpret_cast<const char*>(&len), sizeof(len));
+    }
+    write_padding(file, h.lengths_offset + n * sizeof(uint32_t), h.offsets_offset);
+    file.write(reinterpret_cast<const char*>(offsets.data()), static_cast<std::streamsize>(n * sizeof(uint64_t)));
+    write_padding(file, h.offsets_offset + n * sizeof(uint64_t), h.slab_offset);
+    for(uint64_t i = 0; i < n; i++)
+    {
+        uint64_t len = genomes[i]->len();
+        uint64_t padded = i + 1 < n ? offsets[i + 1] - offsets[i] : slab - offsets[i];
+        file.write(genomes[i]->all_data(), static_cast<std::streamsize>(len));
+        //Padding can exceed one 64 byte block for units wider than that.
+        for(uint64_t p = len; p < padded; p += kAlign)
+        {
+            write_padding(file, p, p + kAlign < padded ? p + kAlign : padded);
+        }
+    }
+    for(const Gene& g : genes)
+    {
+        uint64_t words[kGeneWords];
+        const uint_fast64_t* data = g.get_data();
+        for(unsigned int w = 0; w < 5; w++)
+        {
+            words[w] = data[w];
+        }
+        words[5] = g.slot();
+        file.write(reinterpret_cast<const char*>(words), sizeof(words));
+    }
+    file.flush();
+    bool ok = !file.fail();
+    file.close();
+    return ok ? 1 : 0;
+}
+
+PopulationImage::PopulationImage() :
+    m_base(nullptr),
+    m_size(0),
+    m_header(nullptr),
+    m_seeds(nullptr),
+    m_lengths(nullptr),
+    m_offsets(nullptr),
+    m_slab(nullptr),
+    m_genes(nullptr)
+{
+}
+
+PopulationImage::~PopulationImage()
+{
+    unmap();
+}
+
+void PopulationImage::unmap()
+{
+    if(m_base != nullptr)
+    {
+        munmap(const_cast<char*>(m_base), m_size);
+        m_base = nullptr;
+        m_size = 0;
+        m_header = nullptr;
+    }
+}
+
+int PopulationImage::open(const std::string& path)
+{
+    unmap();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        return 0;
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < sizeof(PopulationImageHeader))
+    {
+        close(fd);
+        return 0;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* base = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    //The mapping keeps the file alive.
+    close(fd);
+    if(base == MAP_FAILED)
+    {
+        return 0;
+    }
+
+    const PopulationImageHeader* h = static_cast<const PopulationImageHeader*>(base);
+    uint64_t n = h->genomes;
+    bool valid = memcmp(h->magic, kMagic, sizeof(kMagic)) == 0
+        && h->version == kVersion
+        && h->byte_order == kByteOrder
+        && h->unit_size == CharDna::unit_size
+        && h->total_bytes == size
+        && n <= size
+        && in_image(h->seeds_offset, n * sizeof(uint64_t), size)
+        && in_image(h->lengths_offset, n * sizeof(uint32_t), size)
+        && in_image(h->offsets_offset, n * sizeof(uint64_t), size)
+        && h->slab_offset <= h->genes_offset
+        && h->genes <= size
+        && in_image(h->slab_offset, h->genes_offset - h->slab_offset, size)
+        && in_image(h->genes_offset, h->genes * kGeneWords * sizeof(uint64_t), size);
+    if(valid)
+    {
+        //Every genome's bytes must lie inside the slab.
+        const char* b = static_cast<const char*>(base);
+        const uint32_t* lengths = reinterpret_cast<const uint32_t*>(b + h->lengths_offset);
+        const uint64_t* offsets = reinterpret_cast<const uint64_t*>(b + h->offsets_offset);
+        uint64_t slab = h->genes_offset - h->slab_offset;
+        for(uint64_t i = 0; i < n && valid; i++)
+        {
+            valid = offsets[i] <= slab && lengths[i] <= slab - offsets[i];
+        }
+    }
+    if(!valid)
+    {
+        munmap(base, size);
+        return 0;
+    }
+
+    m_base = static_cast<const char*>(base);
+    m_size = size;
+    m_header = h;
+    m_seeds = reinterpret_cast<const uint64_t*>(m_base + h->seeds_offset);
+    m_lengths = reinterpret_cast<const uint32_t*>(m_base + h->lengths_offset);
+    m_offsets = reinterpret_cast<const uint64_t*>(m_base + h->offsets_offset);
+    m_slab = m_base + h->slab_offset;
+    m_genes = reinterpret_cast<const uint64_t*>(m_base + h->genes_offset);
+    return 1;
+}
+
+Gene PopulationImage::gene(size_t index) const
+{
+    const uint64_t* w = gene_data(index);
+    uint_fast64_t data[5] = {w[0], w[1], w[2], w[3], w[4]};
+    return Gene(data, static_cast<unsigned char>(w[5]));
+}
@@ -0,0 +1,139 @@
+#ifndef fn_POPULATION_IMAGE_H
+#define fn_POPULATION_IMAGE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#include "char_dna.h"
+#include "gene.h"
+
+//Whole-population snapshot image. One file holds every genome's seed, length
+//and bytes plus a gene table, laid out as fixed-width columns at offsets from
+//the start of the file. Nothing in the image is a pointer, so it can be
+//mmapped at any address and read in place on restart. Opening checks the
+//header (including that the unit size is fn_UNIT_SIZE), that every table
+//lies inside the file and that every genome lies inside the slab; genome
+//bytes themselves are not read until used.
+//
+//Layout, every column aligned to 64 bytes:
+//  header       PopulationImageHeader
+//  seeds        uint64_t[genomes]
+//  lengths      uint32_t[genomes]
+//  offsets      uint64_t[genomes], byte offset of each genome in the slab
+//  slab         genome bytes, each padded to whole units and 64-byte aligned
+//  genes        uint64_t[genes * 6], five data words then the slot count
+//
+//Integers are stored in host byte order; an image only opens on a host with
+//the byte order it was written on.
+
+struct PopulationImageHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t unit_size;
+    uint32_t reserved;
+    uint64_t genomes;
+    uint64_t genes;
+    uint64_t seeds_offset;
+    uint64_t lengths_offset;
+    uint64_t offsets_offset;
+    uint64_t slab_offset;
+    uint64_t genes_offset;
+    uint64_t total_bytes;
+};
+
+/**
+ * Writes the genomes and gene table to path as one image. Returns 1 on
+ * success, 0 on failure.
+ */
+int write_population_image(const std::string& path, const std::vector<const CharDna*>& genomes,
+    const std::vector<Gene>& genes);
+
+/**
+ * Read-only view of an image mapped from disk. Accessors read straight from
+ * the mapping; pages are faulted in on first use.
+ */
+class PopulationImage
+{
+private:
+    const char* m_base;
+    size_t m_size;
+    const PopulationImageHeader* m_header;
+    const uint64_t* m_seeds;
+    const uint32_t* m_lengths;
+    const uint64_t* m_offsets;
+    const char* m_slab;
+    const uint64_t* m_genes;
+
+    void unmap();
+
+public:
+    PopulationImage();
+    PopulationImage(const PopulationImage&) = delete;
+    PopulationImage& operator=(const PopulationImage&) = delete;
+    ~PopulationImage();
+
+    /**
+     * Maps the image at path, replacing any image already open. Returns 1 on
+     * success, 0 if the file is missing or is not a valid image.
+     */
+    int open(const std::string& path);
+
+    bool is_open() const
+    {
+        return m_base != nullptr;
+    }
+
+    //Genomes in the image, 0 if none is open.
+    size_t size() const
+    {
+        return m_header == nullptr ? 0 : m_header->genomes;
+    }
+
+    //Unit size the image was written with, 0 if none is open.
+    uint_fast32_t unit_size() const
+    {
+        return m_header == nullptr ? 0 : m_header->unit_size;
+    }
+
+    uint_fast64_t seed(size_t index) const
+    {
+        return m_seeds[index];
+    }
+
+    uint_fast32_t len(size_t index) const
+    {
+        return m_lengths[index];
+    }
+
+    //Bytes of a genome, inside the mapping.
+    const char* data(size_t index) const
+    {
+        return m_slab + m_offsets[index];
+    }
+
+    //Genes in the image, 0 if none is open.
+    size_t genes() const
+    {
+        return m_header == nullptr ? 0 : m_header->genes;
+    }
+
+    //Five data words of a gene, in the order of Gene::get_data().
+    const uint64_t* gene_data(size_t index) const
+    {
+        return m_genes + index * 6;
+    }
+
+    Gene gene(size_t index) const;
+
+    //Copies one genome out of the image.
+    CharDna to_genome(size_t index) const
+    {
+        return CharDna(seed(index), len(index), data(index));
+    }
+};
+
+#endif
@@ -0,0 +1,170 @@
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <thread>
+
+#include "phase_timing.h"
+#include "ranking.h"
+
+namespace
+{
+
+const unsigned int kRadixBits = 8;
+const unsigned int kBuckets = 1u << kRadixBits;
+//Below this many entries per thread, spawning costs more than it saves.
+const size_t kMinPerThread = 1u << 16;
+
+//Runs fn(t) for t in [0, threads), on threads - 1 new threads and this one.
+void run_parallel(unsigned int threads, const std::function<void(unsigned int)>& fn)
+{
+    std::vector<std::thread> workers;
+    for(unsigned int t = 1; t < threads; t++)
+    {
+        workers.emplace_back(fn, t);
+    }
+    fn(0);
+    for(std::thread& w : workers)
+    {
+        w.join();
+    }
+}
+
+bool key_less(const RankEntry& a, const RankEntry& b)
+{
+    return a.key < b.key || (a.key == b.key && a.index < b.index);
+}
+
+} //namespace
+
+uint64_t fitness_key(double fitness, bool higher_is_better)
+{
+    if(std::isnan(fitness))
+    {
+        return UINT64_MAX;
+    }
+    uint64_t bits;
+    memcpy(&bits, &fitness, sizeof(bits));
+    //Negative values sort reversed by their bits; flip them, and set the sign
+    //bit of positives so they land above.
+    uint64_t key = (bits >> 63) != 0 ? ~bits : bits | (1ull << 63);
+    return higher_is_better ? ~key : key;
+}
+
+std::vector<RankEntry> rank_entries(const std::vector<double>& fitness, bool higher_is_better)
+{
+    std::vector<RankEntry> entries(fitness.size());
+    for(size_t i = 0; i < fitness.size(); i++)
+    {
+        entries[i].key = fitness_key(fitness[i], higher_is_better);
+        entries[i].index = i;
+    }
+    return entries;
+}
+
+void radix_sort_pairs(std::vector<RankEntry>& entries, unsigned int threads)
+{
+    size_t n = entries.size();
+    if(n < 2)
+    {
+        return;
+    }
+    if(threads == 0)
+    {
+        threads = std::thread::hardware_concurrency();
+    }
+    threads = static_cast<unsigned int>(std::min<size_t>(threads, n / kMinPerThread));
+    if(threads == 0)
+    {
+        threads = 1;
+    }
+    size_t block = (n + threads - 1) / threads;
+
+    //Bits that differ between any two keys; other bytes need no pass.
+    uint64_t diff = 0;
+    for(size_t i = 1; i < n; i++)
+    {
+        diff |= entries[i].key ^ entries[0].key;
+    }
+
+    std::vector<RankEntry> scratch(n);
+    RankEntry* src = entries.data();
+    RankEntry* dst = scratch.data();
+    std::vector<size_t> offsets(static_cast<size_t>(threads) * kBuckets);
+    for(unsigned int shift = 0; shift < 64; shift += kRadixBits)
+    {
+        if(((diff >> shift) & (kBuckets - 1)) == 0)
+        {
+            continue;
+        }
+        run_parallel(threads, [&](unsigned int t) {
+            size_t* count = offsets.data() + static_cast<size_t>(t) * kBuckets;
+            std::fill(count, count + kBuckets, 0);
+            size_t end = std::min(n, (t + 1) * block);
+            for(size_t i = t * block; i < end; i++)
+            {
+                count[(src[i].key >> shift) & (kBuckets - 1)]++;
+            }
+        });
+        //Digit-major prefix sum: thread t writes digit d after threads < t.
+        size_t sum = 0;
+        for(unsigned int d = 0; d < kBuckets; d++)
+        {
+            for(unsigned int t = 0; t < threads; t++)
+            {
+                size_t c = offsets[static_cast<size_t>(t) * kBuckets + d];
+                offsets[static_cast<size_t>(t) * kBuckets + d] = sum;
+                sum += c;
+            }
+        }
+        run_parallel(threads, [&](unsigned int t) {
+            size_t* next = offsets.data() + static_cast<size_t>(t) * kBuckets;
+            size_t end = std::min(n, (t + 1) * block);
+            for(size_t i = t * block; i < end; i++)
+            {
+                dst[next[(src[i].key >> shift) & (kBuckets - 1)]++] = src[i];
+            }
+        });
+        std::swap(src, dst);
+    }
+    if(src != entries.data())
+    {
+        entries.swap(scratch);
+    }
+}
+
+std::vector<uint64_t> rank_by_fitness(const std::vector<double>& fitness, bool higher_is_better,
+    unsigned int threads)
+{
+    fn_PHASE_SCOPE(PHASE_SELECTION);
+    std::vector<RankEntry> entries = rank_entries(fitness, higher_is_better);
+    radix_sort_pairs(entries, threads);
+    std::vector<uint64_t> order(entries.size());
+    for(size_t i = 0; i < entries.size(); i++)
+    {
+        order[i] = entries[i].index;
+    }
+    return order;
+}
+
+std::vector<uint64_t> top_k_by_fitness(const std::vector<double>& fitness, size_t k, bool higher_is_better,
+    bool sorted)
+{
+    fn_PHASE_SCOPE(PHASE_SELECTION);
+    std::vector<RankEntry> entries = rank_entries(fitness, higher_is_better);
+    k = std::min(k, entries.size());
+    if(k < entries.size())
+    {
+        std::nth_element(entries.begin(), entries.begin() + k, entries.end(), key_less);
+    }
+    if(sorted)
+    {
+        std::sort(entries.begin(), entries.begin() + k, key_less);
+    }
+    std::vector<uint64_t> best(k);
+    for(size_t i = 0; i < k; i++)
+    {
+        best[i] = entries[i].index;
+    }
+    return best;
+}
@@ -0,0 +1,74 @@
+#ifndef fn_RANKING_H
+#define fn_RANKING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <utility>
+#include <vector>
+
+//Ranking of a population by fitness. Everything works on (key, index) pairs
+//and returns genome indices; genomes themselves are only moved, never copied,
+//and only when the caller asks for it with reorder_by_rank().
+
+/**
+ * Sort key of a genome: key is an order-preserving image of its fitness,
+ * index is its position in the population.
+ */
+struct RankEntry
+{
+    uint64_t key;
+    uint64_t index;
+};
+
+/**
+ * Maps a fitness value to an unsigned key that sorts ascending in the same
+ * order as the doubles. With higher_is_better the order is reversed, so the
+ * best genome always gets the smallest key. NaN ranks last either way.
+ */
+uint64_t fitness_key(double fitness, bool higher_is_better);
+
+/**
+ * Builds one entry per fitness value, index i for fitness[i].
+ */
+std::vector<RankEntry> rank_entries(const std::vector<double>& fitness, bool higher_is_better);
+
+/**
+ * Stable LSD radix sort on key, 8 bits per pass. Passes over bytes that are
+ * equal in every key are skipped. Each pass splits the entries across threads
+ * (0 means one per hardware thread): every thread histograms and then
+ * scatters its own contiguous block. Small inputs run on the calling thread.
+ */
+void radix_sort_pairs(std::vector<RankEntry>& entries, unsigned int threads = 0);
+
+/**
+ * Indices of the whole population, best first. Ties keep index order.
+ */
+std::vector<uint64_t> rank_by_fitness(const std::vector<double>& fitness, bool higher_is_better,
+    unsigned int threads = 0);
+
+/**
+ * Indices of the k best genomes, for elitism. Uses nth_element, so the cost
+ * is linear in the population plus k log k when sorted is true; otherwise
+ * the k indices come back in no particular order.
+ */
+std::vector<uint64_t> top_k_by_fitness(const std::vector<double>& fitness, size_t k, bool higher_is_better,
+    bool sorted = true);
+
+/**
+ * Moves population[order[i]] into position i of the result. order is
+ * normally the output of rank_by_fitness() or top_k_by_fitness(); indices
+ * must be distinct. Moved-from genomes are left empty in population.
+ */
+template<typename Genome>
+std::vector<Genome> reorder_by_rank(std::vector<Genome>& population, const std::vector<uint64_t>& order)
+{
+    std::vector<Genome> out;
+    out.reserve(order.size());
+    for(uint64_t i : order)
+    {
+        out.push_back(std::move(population[i]));
+    }
+    return out;
+}
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef fn_RIBOSOME_H
+#define fn_RIBOSOME_H
+
+#include <memory>
+
+#include "typed_dna.h"
+#include "gene.h"
+
+//Manages dna format
+class Ribosome32
+{
+private:
+    const std::shared_ptr<CharDna> inst;  
+    Int32Dna wrapper;
+    uint_fast32_t geneCt;
+public:
+    Ribosome32(const std::shared_ptr<CharDna> inst) :
+        inst(inst),
+        wrapper(inst)
+    {}
+
+    void addGene(Gene& gene, unsigned int gene_pos)
+    {
+        
+    }
+};
+
+#endif
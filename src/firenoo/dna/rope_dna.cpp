@@ -0,0 +1,315 @@
+#include <string.h>
+
+#include "rope_dna.h"
+
+RopeDna::RopeDna(uint_fast64_t seed) :
+    m_root(kNil),
+    m_seed(seed),
+    m_rng(static_cast<uint32_t>(seed ^ (seed >> 32)) | 1)
+{
+}
+
+RopeDna::RopeDna(const CharDna& genome) :
+    RopeDna(genome.seed())
+{
+    m_root = build(genome.all_data(), genome.len());
+}
+
+uint32_t RopeDna::make_node(const char* data, uint32_t len)
+{
+    uint32_t t;
+    if(!m_free.empty())
+    {
+        t = m_free.back();
+        m_free.pop_back();
+    } else
+    {
+        t = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+    //xorshift32 priorities keep the treap balanced in expectation.
+    m_rng ^= m_rng << 13;
+    m_rng ^= m_rng >> 17;
+    m_rng ^= m_rng << 5;
+    Node& n = m_nodes[t];
+    n.left = kNil;
+    n.right = kNil;
+    n.priority = m_rng;
+    n.size = len;
+    n.len = len;
+    memcpy(n.data, data, len);
+    return t;
+}
+
+void RopeDna::free_tree(uint32_t t)
+{
+    std::vector<uint32_t> stack;
+    if(t != kNil)
+    {
+        stack.push_back(t);
+    }
+    while(!stack.empty())
+    {
+        uint32_t n = stack.back();
+        stack.pop_back();
+        if(m_nodes[n].left != kNil)
+        {
+            stack.push_back(m_nodes[n].left);
+        }
+        if(m_nodes[n].right != kNil)
+        {
+            stack.push_back(m_nodes[n].right);
+        }
+        m_free.push_back(n);
+    }
+}
+
+uint32_t RopeDna::merge(uint32_t a, uint32_t b)
+{
+    if(a == kNil)
+    {
+        return b;
+    }
+    if(b == kNil)
+    {
+        return a;
+    }
+    if(m_nodes[a].priority > m_nodes[b].priority)
+    {
+        uint32_t right = merge(m_nodes[a].right, b);
+        m_nodes[a].right = right;
+        update(a);
+        return a;
+    }
+    uint32_t left = merge(a, m_nodes[b].left);
+    m_nodes[b].left = left;
+    update(b);
+    return b;
+}
+
+void RopeDna::split(uint32_t t, uint32_t pos, uint32_t& l, uint32_t& r)
+{
+    if(t == kNil)
+    {
+        l = kNil;
+        r = kNil;
+        return;
+    }
+    //make_node() may grow m_nodes, so no references are held across calls.
+    uint32_t ls = size(m_nodes[t].left);
+    uint32_t len = m_nodes[t].len;
+    uint32_t a;
+    uint32_t b;
+    if(pos <= ls)
+    {
+        split(m_nodes[t].left, pos, a, b);
+        m_nodes[t].left = b;
+        update(t);
+        l = a;
+        r = t;
+    } else if(pos >= ls + len)
+    {
+        split(m_nodes[t].right, pos - ls - len, a, b);
+        m_nodes[t].right = a;
+        update(t);
+        l = t;
+        r = b;
+    } else
+    {
+        //The cut falls inside this chunk; its tail becomes a new node.
+        uint32_t cut = pos - ls;
+        char tail[kChunk];
+        memcpy(tail, m_nodes[t].data + cut, len - cut);
+        uint32_t n = make_node(tail, len - cut);
+        uint32_t right = m_nodes[t].right;
+        m_nodes[t].len = cut;
+        m_nodes[t].right = kNil;
+        update(t);
+        l = t;
+        r = merge(n, right);
+    }
+}
+
+uint32_t RopeDna::build(const char* data, uint_fast32_t len)
+{
+    uint32_t root = kNil;
+    for(uint_fast32_t at = 0; at < len; at += kChunk)
+    {
+        uint32_t n = static_cast<uint32_t>(len - at < kChunk ? len - at : kChunk);
+        root = merge(root, make_node(data + at, n));
+    }
+    return root;
+}
+
+uint32_t RopeDna::locate(uint_fast32_t& offset) const
+{
+    uint32_t t = m_root;
+    while(t != kNil)
+    {
+        const Node& n = m_nodes[t];
+        uint32_t ls = size(n.left);
+        if(offset < ls)
+        {
+            t = n.left;
+        } else if(offset < ls + n.len)
+        {
+            offset -= ls;
+            return t;
+        } else
+        {
+            offset -= ls + n.len;
+            t = n.right;
+        }
+    }
+    return kNil;
+}
+
+char RopeDna::char_data(uint_fast32_t offset) const
+{
+    uint32_t t = locate(offset);
+    return t == kNil ? 0 : m_nodes[t].data[offset];
+}
+
+void RopeDna::set_char(uint_fast32_t offset, char newData)
+{
+    uint32_t t = locate(offset);
+    if(t != kNil)
+    {
+        m_nodes[t].data[offset] = newData;
+    }
+}
+
+void RopeDna::insert(uint_fast32_t offset, const char* data, uint_fast32_t count)
+{
+    if(offset > len() || count == 0)
+    {
+        return;
+    }
+    if(count <= kChunk && m_root != kNil)
+    {
+        //Find the chunk the bytes go into, inserting at a chunk's end when
+        //the offset falls between two chunks.
+        uint32_t path[64];
+        unsigned int depth = 0;
+        uint32_t t = m_root;
+        uint_fast32_t pos = offset;
+        while(depth < 64)
+        {
+            path[depth++] = t;
+            const Node& n = m_nodes[t];
+            uint32_t ls = size(n.left);
+            if(pos < ls || (pos == ls && pos > 0 && n.left != kNil))
+            {
+                t = n.left;
+                continue;
+            }
+            pos -= ls;
+            if(pos <= n.len || n.right == kNil)
+            {
+                break;
+            }
+            pos -= n.len;
+            t = n.right;
+        }
+        Node& n = m_nodes[t];
+        if(depth < 64 && n.len + count <= kChunk)
+        {
+            memmove(n.data + pos + count, n.data + pos, n.len - pos);
+            memcpy(n.data + pos, data, count);
+            n.len += count;
+            for(unsigned int i = 0; i < depth; i++)
+            {
+                m_nodes[path[i]].size += count;
+            }
+            return;
+        }
+    }
+    uint32_t l;
+    uint32_t r;
+    split(m_root, offset, l, r);
+    m_root = merge(merge(l, build(data, count)), r);
+}
+
+void RopeDna::erase(uint_fast32_t offset, uint_fast32_t count)
+{
+    uint_fast32_t total = len();
+    if(offset >= total || count == 0)
+    {
+        return;
+    }
+    count = count < total - offset ? count : total - offset;
+    //Within one chunk that keeps some bytes: shift in place.
+    uint32_t path[64];
+    unsigned int depth = 0;
+    uint32_t t = m_root;
+    uint_fast32_t pos = offset;
+    while(t != kNil && depth < 64)
+    {
+        path[depth++] = t;
+        const Node& n = m_nodes[t];
+        uint32_t ls = size(n.left);
+        if(pos < ls)
+        {
+            t = n.left;
+        } else if(pos < ls + n.len)
+        {
+            pos -= ls;
+            break;
+        } else
+        {
+            pos -= ls + n.len;
+            t = n.right;
+        }
+    }
+    if(t != kNil && depth < 64 && pos + count < m_nodes[t].len)
+    {
+        Node& n = m_nodes[t];
+        memmove(n.data + pos, n.data + pos + count, n.len - pos - count);
+        n.len -= count;
+        for(unsigned int i = 0; i < depth; i++)
+        {
+            m_nodes[path[i]].size -= count;
+        }
+        return;
+    }
+    uint32_t l;
+    uint32_t rest;
+    uint32_t mid;
+    uint32_t r;
+    split(m_root, offset, l, rest);
+    split(rest, count, mid, r);
+    free_tree(mid);
+    m_root = merge(l, r);
+}
+
+void RopeDna::compact()
+{
+    CharDna flat = flatten();
+    m_nodes.clear();
+    m_free.clear();
+    m_root = build(flat.all_data(), flat.len());
+}
+
+CharDna RopeDna::flatten() const
+{
+    uint_fast32_t total = len();
+    CharDna out(m_seed, total);
+    char* p = out.resize(total);
+    //In-order walk with an explicit stack.
+    std::vector<uint32_t> stack;
+    uint32_t t = m_root;
+    while(t != kNil || !stack.empty())
+    {
+        while(t != kNil)
+        {
+            stack.push_back(t);
+            t = m_nodes[t].left;
+        }
+        t = stack.back();
+        stack.pop_back();
+        memcpy(p, m_nodes[t].data, m_nodes[t].len);
+        p += m_nodes[t].len;
+        t = m_nodes[t].right;
+    }
+    return out;
+}
@@ -0,0 +1,123 @@
+#ifndef fn_ROPE_DNA_H
+#define fn_ROPE_DNA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#include "char_dna.h"
+
+/**
+ * Variable-length genome for insertion and deletion mutations.
+ *
+ * Bytes are kept in chunks of up to kChunk bytes, the leaves of an implicit
+ * treap ordered by position. Every node stores the byte count of its
+ * subtree, so reads, overwrites, inserts and erases find their chunk in
+ * O(log n) expected time. Edits that fit in one chunk shift at most kChunk
+ * bytes; larger ones split the treap at both ends and relink the middle.
+ *
+ * Nodes live in one vector and refer to each other by index, and freed
+ * nodes are reused. Many edits leave partly filled chunks behind; compact()
+ * repacks them. flatten() produces a contiguous CharDna.
+ */
+class RopeDna
+{
+public:
+    static const uint_fast32_t kChunk = CharDna::unit_size * 4;
+
+private:
+    static const uint32_t kNil = UINT32_MAX;
+
+    struct Node
+    {
+        uint32_t left;
+        uint32_t right;
+        uint32_t priority;
+        //Bytes in this subtree.
+        uint32_t size;
+        uint32_t len;
+        char data[kChunk];
+    };
+
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_free;
+    uint32_t m_root;
+    uint_fast64_t m_seed;
+    uint32_t m_rng;
+
+    uint32_t size(uint32_t t) const
+    {
+        return t == kNil ? 0 : m_nodes[t].size;
+    }
+
+    void update(uint32_t t)
+    {
+        Node& n = m_nodes[t];
+        n.size = size(n.left) + n.len + size(n.right);
+    }
+
+    uint32_t make_node(const char* data, uint32_t len);
+    void free_tree(uint32_t t);
+    uint32_t merge(uint32_t a, uint32_t b);
+    void split(uint32_t t, uint32_t pos, uint32_t& l, uint32_t& r);
+    uint32_t build(const char* data, uint_fast32_t len);
+    //Chunk holding offset, with offset made relative to it.
+    uint32_t locate(uint_fast32_t& offset) const;
+
+public:
+    explicit RopeDna(uint_fast64_t seed);
+
+    explicit RopeDna(const CharDna& genome);
+
+    uint_fast32_t len() const
+    {
+        return size(m_root);
+    }
+
+    uint_fast64_t seed() const
+    {
+        return m_seed;
+    }
+
+    //Number of chunks in use.
+    size_t chunks() const
+    {
+        return m_nodes.size() - m_free.size();
+    }
+
+    char char_data(uint_fast32_t offset) const;
+
+    /**
+     * Overwrites the byte at offset. Does nothing if offset >= len().
+     */
+    void set_char(uint_fast32_t offset, char newData);
+
+    void append_char(char newData)
+    {
+        insert(len(), &newData, 1);
+    }
+
+    /**
+     * Inserts count bytes before offset, shifting the rest of the genome.
+     * Does nothing if offset > len().
+     */
+    void insert(uint_fast32_t offset, const char* data, uint_fast32_t count);
+
+    /**
+     * Removes count bytes starting at offset, clamped to the end of the
+     * genome.
+     */
+    void erase(uint_fast32_t offset, uint_fast32_t count);
+
+    /**
+     * Repacks the bytes into full chunks.
+     */
+    void compact();
+
+    /**
+     * Contiguous copy of the genome.
+     */
+    CharDna flatten() const;
+};
+
+#endif
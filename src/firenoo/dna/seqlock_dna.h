@@ -0,0 +1,254 @@
+#ifndef fn_SEQLOCK_DNA_H
+#define fn_SEQLOCK_DNA_H
+
+#include <string.h>
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "char_dna.h"
+#include "epoch.h"
+
+/**
+ * Single-writer/multi-reader DNA. One thread mutates it with the same
+ * set_char/append_char calls as CharDna while any number of threads take
+ * consistent snapshots without locking.
+ *
+ * Writes bump a sequence counter to odd before and to even after; readers
+ * retry if the counter moved while they copied. Growing swaps in a new buffer
+ * and retires the old one through EpochDomain, so a reader that is still
+ * copying from it never sees it freed.
+ *
+ * Several writes can be grouped into one atomic update with begin_write() and
+ * end_write(). Only one thread may write, and the object must not be
+ * destroyed while readers are using it.
+ */
+class SeqlockDna
+{
+private:
+    struct Buffer
+    {
+        uint_fast32_t capacity;
+        std::unique_ptr<std::atomic<char>[]> data;
+
+        explicit Buffer(uint_fast32_t cap) :
+            capacity(cap),
+            data(new std::atomic<char>[cap])
+        {
+        }
+    };
+
+    std::atomic<Buffer*> m_buf;
+    std::atomic<uint_fast64_t> m_seq;
+    std::atomic<uint_fast32_t> m_len;
+    const uint_fast64_t m_seed;
+    //Writer-only state.
+    unsigned int m_depth;
+    std::vector<std::pair<uint_fast64_t, Buffer*>> m_retired;
+
+    void reclaim()
+    {
+        EpochDomain& domain = EpochDomain::global();
+        size_t kept = 0;
+        for(size_t i = 0; i < m_retired.size(); i++)
+        {
+            if(domain.safe_to_free(m_retired[i].first))
+            {
+                delete m_retired[i].second;
+            } else
+            {
+                m_retired[kept++] = m_retired[i];
+            }
+        }
+        m_retired.resize(kept);
+    }
+
+    void grow(uint_fast32_t newLen)
+    {
+        Buffer* old = m_buf.load(std::memory_order_relaxed);
+        Buffer* next = new Buffer(newLen);
+        uint_fast32_t len = m_len.load(std::memory_order_relaxed);
+        for(uint_fast32_t i = 0; i < newLen; i++)
+        {
+            next->data[i].store(i < len ? old->data[i].load(std::memory_order_relaxed) : 0,
+                std::memory_order_relaxed);
+        }
+        m_buf.store(next, std::memory_order_release);
+        m_retired.emplace_back(EpochDomain::global().retire_tag(), old);
+        reclaim();
+    }
+
+    void init(uint_fast32_t init_len, const char* src, uint_fast32_t src_len)
+    {
+        Buffer* buf = new Buffer(init_len);
+        for(uint_fast32_t i = 0; i < init_len; i++)
+        {
+            buf->data[i].store(i < src_len ? src[i] : 0, std::memory_order_relaxed);
+        }
+        m_buf.store(buf, std::memory_order_release);
+    }
+
+public:
+    SeqlockDna(uint_fast64_t seed, uint_fast32_t init_len) :
+        m_seq(0),
+        m_len(0),
+        m_seed(seed),
+        m_depth(0)
+    {
+        init(init_len, nullptr, 0);
+    }
+
+    explicit SeqlockDna(const CharDna& src) :
+        m_seq(0),
+        m_len(src.len()),
+        m_seed(src.seed()),
+        m_depth(0)
+    {
+        init(src.capacity(), src.all_data(), src.len());
+    }
+
+    ~SeqlockDna()
+    {
+        for(const std::pair<uint_fast64_t, Buffer*>& r : m_retired)
+        {
+            delete r.second;
+        }
+        delete m_buf.load(std::memory_order_relaxed);
+    }
+
+    SeqlockDna(const SeqlockDna&) = delete;
+    SeqlockDna& operator=(const SeqlockDna&) = delete;
+
+    /**
+     * Starts a group of writes that readers see all at once. Calls nest.
+     * Writer thread only.
+     */
+    void begin_write()
+    {
+        if(m_depth++ == 0)
+        {
+            m_seq.store(m_seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+    }
+
+    void end_write()
+    {
+        if(--m_depth == 0)
+        {
+            m_seq.store(m_seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+    }
+
+    /**
+     * Sets the data at the offset to the specified char, allocating new space
+     * as necessary. Writer thread only.
+     */
+    void set_char(uint_fast32_t offset, char newData)
+    {
+        begin_write();
+        Buffer* buf = m_buf.load(std::memory_order_relaxed);
+        if(offset >= buf->capacity)
+        {
+            grow((offset + 1) * 2);
+            buf = m_buf.load(std::memory_order_relaxed);
+        }
+        buf->data[offset].store(newData, std::memory_order_relaxed);
+        if(offset >= m_len.load(std::memory_order_relaxed))
+        {
+            m_len.store(offset + 1, std::memory_order_relaxed);
+        }
+        end_write();
+    }
+
+    void append_char(char newData)
+    {
+        set_char(m_len.load(std::memory_order_relaxed), newData);
+    }
+
+    /**
+     * Copies a consistent state of the data into a new CharDna. Safe from any
+     * thread; spins while a write is in progress.
+     */
+    CharDna snapshot() const
+    {
+        std::unique_ptr<char[]> tmp;
+        uint_fast32_t tmp_cap = 0;
+        for(;;)
+        {
+            EpochDomain::Guard guard(EpochDomain::global());
+            uint_fast64_t s1 = m_seq.load(std::memory_order_acquire);
+            if(s1 & 1)
+            {
+                continue;
+            }
+            const Buffer* buf = m_buf.load(std::memory_order_acquire);
+            uint_fast32_t len = m_len.load(std::memory_order_relaxed);
+            if(len > buf->capacity)
+            {
+                continue;
+            }
+            if(len > tmp_cap)
+            {
+                tmp.reset(new char[len]);
+                tmp_cap = len;
+            }
+            for(uint_fast32_t i = 0; i < len; i++)
+            {
+                tmp[i] = buf->data[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if(m_seq.load(std::memory_order_relaxed) == s1)
+            {
+                return CharDna(m_seed, len, tmp.get());
+            }
+        }
+    }
+
+    /**
+     * Reads one byte consistently; returns 0 past the end. Safe from any thread.
+     */
+    char char_data(uint_fast32_t offset) const
+    {
+        for(;;)
+        {
+            EpochDomain::Guard guard(EpochDomain::global());
+            uint_fast64_t s1 = m_seq.load(std::memory_order_acquire);
+            if(s1 & 1)
+            {
+                continue;
+            }
+            const Buffer* buf = m_buf.load(std::memory_order_acquire);
+            char c = offset < m_len.load(std::memory_order_relaxed) && offset < buf->capacity
+                ? buf->data[offset].load(std::memory_order_relaxed) : 0;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if(m_seq.load(std::memory_order_relaxed) == s1)
+            {
+                return c;
+            }
+        }
+    }
+
+    uint_fast32_t len() const
+    {
+        return m_len.load(std::memory_order_acquire);
+    }
+
+    uint_fast64_t seed() const
+    {
+        return m_seed;
+    }
+
+    /**
+     * Number of completed write groups. Readers can compare versions to see
+     * whether anything changed since their last snapshot.
+     */
+    uint_fast64_t version() const
+    {
+        return m_seq.load(std::memory_order_acquire) / 2;
+    }
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef fn_SERIALIZE_H
+#define fn_SERIALIZE_H
+
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+#include "char_dna.h"
+
+//File format: "TDNA", an int32 version and an int64 record count, then per
+//record an int32 header length, an int32 payload length, the header and the
+//payload. The header is a run of fields, each a 16-bit tag, a 16-bit value
+//length and the value, so readers skip it in one step and ignore tags they
+//do not know. All integers are little endian. Files in the original format,
+//which has '\n'-terminated headers, are still read.
+
+/**
+ * One record of a dna file, as stored on disk. data points at len bytes and
+ * is only valid for the duration of the callback it is passed to.
+ *
+ * A record may share the payload of an earlier record instead of storing
+ * its own: ref is then the index of that record, and data/len describe the
+ * shared bytes. Such records are written with no data after the header.
+ *
+ * Payloads are written with a 128-bit checksum that is verified on read.
+ */
+struct DnaRecord
+{
+    static const uint_fast32_t kNoRef = UINT32_MAX;
+    static const uint_fast64_t kNoLineage = UINT64_MAX;
+
+    uint_fast64_t seed;
+    uint_fast32_t unit_size;
+    uint_fast32_t len;
+    const char* data;
+    uint_fast32_t ref = kNoRef;
+    uint_fast32_t type_id = fn_TYPEDDNA_ID;
+    //0 when the genome has no schema.
+    uint_fast32_t schema_id = 0;
+    //LineageLog id, if tracked.
+    uint_fast64_t lineage = kNoLineage;
+};
+
+/**
+ * Reads every record in the file pointed to by the path and passes it to
+ * sink, resolving shared payloads. Returns 1 on success, 0 on failure.
+ */
+int read_dna_records(const std::string& path, const std::function<void(const DnaRecord&)>& sink);
+
+/**
+ * Writes the records to the specified file path. A record whose ref is set
+ * is written as a reference to records[ref], which must come before it;
+ * otherwise nothing is written. Returns 1 on success, 0 on failure.
+ */
+int write_dna_records(const std::string& path, const std::vector<DnaRecord>& records);
+
+/**
+ * Deserializes the dna objects in the file pointed to by the path.
+ * Inserts all deserialized dna objects into the supplied std::vector.
+ * Records written with another unit size are converted: the bytes and seed
+ * carry over, and capacity is rounded to UnitSize.
+ * Returns 1 on success, 0 on failure.
+ */
+template<uint_fast32_t UnitSize>
+int deserialize(const std::string& path, std::vector<BasicCharDna<UnitSize>>& vec)
+{
+    return read_dna_records(path, [&vec](const DnaRecord& r)
+    {
+        vec.emplace_back(r.seed, r.len, r.data);
+    });
+}
+
+/**
+ * Serializes the dna objects to the specified file path, recording UnitSize
+ * as the unit size of each.
+ */
+template<uint_fast32_t UnitSize>
+void serialize(const std::string& path, std::initializer_list<BasicCharDna<UnitSize>*> list)
+{
+    std::vector<DnaRecord> records;
+    records.reserve(list.size());
+    for(const BasicCharDna<UnitSize>* d : list)
+    {
+        records.push_back(DnaRecord{d->seed(), UnitSize, d->len(), d->all_data()});
+    }
+    write_dna_records(path, records);
+}
+
+#endif
@@ -0,0 +1,184 @@
+#ifndef fn_SPARSE_DNA_H
+#define fn_SPARSE_DNA_H
+
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <algorithm>
+#include <vector>
+
+#include "char_dna.h"
+
+/**
+ * Genome that stores only its non-zero units. Units are UnitSize bytes, as
+ * for BasicCharDna; the unit indices that hold a non-zero byte are kept
+ * sorted in one vector and their bytes in another, in the same order.
+ *
+ * Reads and overwrites binary search the index. Writing into a new unit
+ * inserts it in order, which is O(1) when appending and shifts later units
+ * otherwise. Writing zeros never allocates, and a unit that becomes all
+ * zero is dropped.
+ *
+ * Scans iterate units 0..units() - 1 through unit_offset() and unit_data()
+ * and skip empty regions entirely.
+ */
+template<uint_fast32_t UnitSize>
+class BasicSparseDna
+{
+private:
+    std::vector<uint32_t> m_units;
+    std::vector<char> m_data;
+    uint_fast64_t m_seed;
+    uint_fast32_t m_len;
+
+    //Position of unit u in m_units, or where it would be inserted.
+    size_t find(uint_fast32_t u) const
+    {
+        if(!m_units.empty() && m_units.back() < u)
+        {
+            return m_units.size();
+        }
+        return std::lower_bound(m_units.begin(), m_units.end(), u) - m_units.begin();
+    }
+
+    static bool all_zero(const char* p)
+    {
+        char acc = 0;
+        for(uint_fast32_t i = 0; i < UnitSize; i++)
+        {
+            acc |= p[i];
+        }
+        return acc == 0;
+    }
+
+public:
+    static constexpr uint_fast32_t unit_size = UnitSize;
+
+    BasicSparseDna(uint_fast64_t seed, uint_fast32_t len = 0) :
+        m_seed(seed),
+        m_len(len)
+    {
+    }
+
+    /**
+     * Copies the non-zero units of a dense genome.
+     */
+    static BasicSparseDna from_dense(const BasicCharDna<UnitSize>& dense)
+    {
+        BasicSparseDna out(dense.seed(), dense.len());
+        const char* src = dense.all_data();
+        //Dense capacity is whole units and zero past len, so full units are safe to read.
+        uint_fast32_t units = BasicCharDna<UnitSize>::round_up(dense.len()) / UnitSize;
+        for(uint_fast32_t u = 0; u < units; u++)
+        {
+            if(!all_zero(src + u * UnitSize))
+            {
+                out.m_units.push_back(static_cast<uint32_t>(u));
+                out.m_data.insert(out.m_data.end(), src + u * UnitSize, src + (u + 1) * UnitSize);
+            }
+        }
+        return out;
+    }
+
+    /**
+     * Dense copy of the genome.
+     */
+    BasicCharDna<UnitSize> to_dense() const
+    {
+        BasicCharDna<UnitSize> out(m_seed, m_len);
+        char* dst = out.resize(m_len);
+        for(size_t i = 0; i < m_units.size(); i++)
+        {
+            uint_fast32_t at = m_units[i] * UnitSize;
+            uint_fast32_t n = std::min<uint_fast32_t>(UnitSize, m_len - at);
+            memcpy(dst + at, m_data.data() + i * UnitSize, n);
+        }
+        return out;
+    }
+
+    char char_data(uint_fast32_t offset) const
+    {
+        uint_fast32_t u = offset / UnitSize;
+        size_t i = find(u);
+        if(i == m_units.size() || m_units[i] != u)
+        {
+            return 0;
+        }
+        return m_data[i * UnitSize + offset % UnitSize];
+    }
+
+    /**
+     * Sets the byte at offset, extending the length as necessary.
+     */
+    void set_char(uint_fast32_t offset, char newData)
+    {
+        if(offset >= m_len)
+        {
+            m_len = offset + 1;
+        }
+        uint_fast32_t u = offset / UnitSize;
+        size_t i = find(u);
+        bool present = i < m_units.size() && m_units[i] == u;
+        if(!present)
+        {
+            if(newData == 0)
+            {
+                return;
+            }
+            m_units.insert(m_units.begin() + i, static_cast<uint32_t>(u));
+            m_data.insert(m_data.begin() + i * UnitSize, UnitSize, 0);
+        }
+        char* p = m_data.data() + i * UnitSize;
+        p[offset % UnitSize] = newData;
+        if(newData == 0 && all_zero(p))
+        {
+            m_units.erase(m_units.begin() + i);
+            m_data.erase(m_data.begin() + i * UnitSize, m_data.begin() + (i + 1) * UnitSize);
+        }
+    }
+
+    void append_char(char newData)
+    {
+        set_char(m_len, newData);
+    }
+
+    uint_fast32_t len() const
+    {
+        return m_len;
+    }
+
+    uint_fast64_t seed() const
+    {
+        return m_seed;
+    }
+
+    //Number of non-zero units stored.
+    size_t units() const
+    {
+        return m_units.size();
+    }
+
+    //Byte offset in the genome of the i-th stored unit.
+    uint_fast32_t unit_offset(size_t i) const
+    {
+        return m_units[i] * UnitSize;
+    }
+
+    //UnitSize bytes of the i-th stored unit.
+    const char* unit_data(size_t i) const
+    {
+        return m_data.data() + i * UnitSize;
+    }
+
+    /**
+     * Bytes held by the block map.
+     */
+    size_t footprint() const
+    {
+        return m_units.capacity() * sizeof(uint32_t) + m_data.capacity();
+    }
+};
+
+typedef BasicSparseDna<fn_UNIT_SIZE> SparseDna;
+
+#endif
@@ -0,0 +1,102 @@
+#include <stdint.h>
+#include <vector>
+
+#include "../allele_stats.h"
+#include "../genome_init.h"
+#include "test.h"
+
+namespace
+{
+
+//count random genomes of len bytes; every third one is shorter, so reads
+//past a genome's length are exercised.
+std::vector<CharDna> make_genomes(size_t count, uint_fast32_t len)
+{
+    std::vector<CharDna> out;
+    for(size_t i = 0; i < count; i++)
+    {
+        out.emplace_back(i, 0);
+        random_fill(out.back(), i % 3 == 0 ? len / 2 + static_cast<uint_fast32_t>(i % 5) : len);
+    }
+    return out;
+}
+
+std::vector<const CharDna*> views(const std::vector<CharDna>& genomes)
+{
+    std::vector<const CharDna*> out;
+    for(const CharDna& g : genomes)
+    {
+        out.push_back(&g);
+    }
+    return out;
+}
+
+unsigned char byte_at(const CharDna& g, uint_fast32_t i)
+{
+    return i < g.len() ? static_cast<unsigned char>(g.char_data(i)) : 0;
+}
+
+} //namespace
+
+//Enough loci for the SSE2 path and a scalar tail; enough updates to fold
+//the 16-bit pending counters into the totals.
+fn_TEST(allele_stats, counts_match_recount)
+{
+    const uint_fast32_t kLoci = 40;
+    std::vector<CharDna> genomes = make_genomes(300, kLoci);
+    AlleleStats stats(kLoci, fn_INT);
+    for(unsigned int round = 0; round < 120; round++)
+    {
+        stats.insert(views(genomes));
+        stats.remove(views(genomes));
+    }
+    stats.insert(views(genomes));
+    //Drop the first 50 again.
+    for(size_t i = 0; i < 50; i++)
+    {
+        stats.remove(genomes[i]);
+    }
+    fn_CHECK(stats.individuals() == genomes.size() - 50);
+    bool same = true;
+    for(uint_fast32_t bit = 0; bit < kLoci * 8; bit++)
+    {
+        uint_fast64_t c = 0;
+        for(size_t i = 50; i < genomes.size(); i++)
+        {
+            c += (byte_at(genomes[i], bit / 8) >> (bit % 8)) & 1;
+        }
+        same = same && stats.allele_count(bit) == c;
+    }
+    fn_CHECK(same);
+    fn_CHECK(stats.genes() == kLoci / 4);
+    //Mean and variance of gene 0 against a direct recount.
+    double sum = 0.0;
+    double sumsq = 0.0;
+    for(size_t i = 50; i < genomes.size(); i++)
+    {
+        double v = 0.0;
+        for(unsigned int b = 0; b < 4; b++)
+        {
+            v += static_cast<double>(byte_at(genomes[i], b)) * static_cast<double>(1ull << (8 * b));
+        }
+        sum += v;
+        sumsq += v * v;
+    }
+    double n = static_cast<double>(genomes.size() - 50);
+    double mean = sum / n;
+    double var = sumsq / n - mean * mean;
+    fn_CHECK(stats.mean(0) > mean * (1 - 1e-12) && stats.mean(0) < mean * (1 + 1e-12));
+    fn_CHECK(stats.variance(0) > var * (1 - 1e-6) && stats.variance(0) < var * (1 + 1e-6));
+}
+
+fn_TEST(allele_stats, entropy_of_agreeing_population_is_zero)
+{
+    std::vector<CharDna> same(10, CharDna(1, 4, "abcd"));
+    AlleleStats stats(4);
+    stats.insert(views(same));
+    fn_CHECK(stats.mean_entropy() == 0.0);
+    CharDna other(2, 4, "abce");
+    stats.insert(other);
+    fn_CHECK(stats.entropy(3) > 0.0);
+    fn_CHECK(stats.entropy(0) == 0.0);
+}
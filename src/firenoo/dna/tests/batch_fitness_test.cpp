@@ -0,0 +1,110 @@
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../batch_fitness.h"
+#include "../fitness_cache.h"
+#include "test.h"
+
+namespace
+{
+
+//Sum of the genome's bytes; counts the genomes and batches it was given.
+class CountingSum : public BatchFitness
+{
+public:
+    std::atomic<uint_fast64_t> genomes{0};
+    std::mutex lock;
+    std::vector<uint_fast32_t> batches;
+
+    void evaluate(const FitnessBatch& batch) override
+    {
+        for(uint_fast32_t i = 0; i < batch.count; i++)
+        {
+            batch.fitness[i] = score(*batch.genomes[i]);
+        }
+        genomes += batch.count;
+        std::lock_guard<std::mutex> guard(lock);
+        batches.push_back(batch.count);
+    }
+
+    static double score(const CharDna& g)
+    {
+        double s = 0;
+        for(uint_fast32_t i = 0; i < g.len(); i++)
+        {
+            s += static_cast<unsigned char>(g.char_data(i));
+        }
+        return s;
+    }
+};
+
+CharDna genome(uint_fast64_t seed, char fill)
+{
+    return CharDna(seed, 8, std::string(8, fill).c_str());
+}
+
+} //namespace
+
+fn_TEST(engine, range_without_cache)
+{
+    std::vector<CharDna> owned;
+    for(uint_fast64_t i = 0; i < 70; i++)
+    {
+        owned.push_back(genome(i, static_cast<char>(i)));
+    }
+    std::vector<const CharDna*> views;
+    for(const CharDna& g : owned)
+    {
+        views.push_back(&g);
+    }
+    CountingSum fn;
+    FitnessEngine engine(fn, 16);
+    std::vector<double> fitness(30);
+    engine.evaluate(views, 20, 30, fitness.data());
+    bool same = true;
+    for(size_t i = 0; i < fitness.size(); i++)
+    {
+        same = same && fitness[i] == CountingSum::score(owned[20 + i]);
+    }
+    fn_CHECK(same);
+    fn_CHECK(fn.batches == std::vector<uint_fast32_t>({16, 14}));
+}
+
+fn_TEST(engine, cached_results_match_direct)
+{
+    std::vector<CharDna> owned;
+    for(uint_fast64_t i = 0; i < 1000; i++)
+    {
+        //Only 100 distinct genomes.
+        owned.push_back(genome(i % 100, static_cast<char>(i % 100)));
+    }
+    std::vector<const CharDna*> views;
+    for(const CharDna& g : owned)
+    {
+        views.push_back(&g);
+    }
+    for(unsigned int threads : {1u, 4u})
+    {
+        CountingSum fn;
+        FitnessCache cache(4096, true);
+        FitnessEngine engine(fn, 32, &cache);
+        std::vector<double> fitness;
+        engine.evaluate(views, fitness, threads);
+        bool same = fitness.size() == owned.size();
+        for(size_t i = 0; i < fitness.size(); i++)
+        {
+            same = same && fitness[i] == CountingSum::score(owned[i]);
+        }
+        fn_CHECK(same);
+        //Copies are evaluated once.
+        fn_CHECK(fn.genomes.load() == 100);
+        //Misses are cut into full batches; only the last may be short.
+        fn_CHECK(fn.batches.size() == 4);
+        engine.evaluate(views, fitness, threads);
+        fn_CHECK(fn.genomes.load() == 100);
+        fn_CHECK(cache.hits() == 1000);
+    }
+}
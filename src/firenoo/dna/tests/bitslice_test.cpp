@@ -0,0 +1,135 @@
+#include <stdint.h>
+#include <vector>
+
+#include "../bitslice.h"
+#include "../genome_init.h"
+#include "test.h"
+
+namespace
+{
+
+//count random genomes of len bytes; every third one is shorter, so reads
+//past a genome's length are exercised.
+std::vector<CharDna> make_genomes(size_t count, uint_fast32_t len)
+{
+    std::vector<CharDna> out;
+    for(size_t i = 0; i < count; i++)
+    {
+        out.emplace_back(i, 0);
+        random_fill(out.back(), i % 3 == 0 ? len / 2 + static_cast<uint_fast32_t>(i % 5) : len);
+    }
+    return out;
+}
+
+std::vector<const CharDna*> views(const std::vector<CharDna>& genomes)
+{
+    std::vector<const CharDna*> out;
+    for(const CharDna& g : genomes)
+    {
+        out.push_back(&g);
+    }
+    return out;
+}
+
+unsigned char byte_at(const CharDna& g, uint_fast32_t i)
+{
+    return i < g.len() ? static_cast<unsigned char>(g.char_data(i)) : 0;
+}
+
+} //namespace
+
+fn_TEST(bitslice, genomes_round_trip)
+{
+    const uint_fast32_t kBytes = 19;
+    std::vector<CharDna> genomes = make_genomes(130, kBytes);
+    BitSlicedPopulation pop = BitSlicedPopulation::from_genomes(views(genomes), kBytes);
+    fn_CHECK(pop.bits() == kBytes * 8);
+    fn_CHECK(pop.individuals() == genomes.size());
+    bool same = true;
+    for(size_t i = 0; i < genomes.size(); i++)
+    {
+        CharDna back = pop.to_genome(i, 99);
+        same = same && back.len() == kBytes && back.seed() == 99;
+        for(uint_fast32_t b = 0; b < kBytes; b++)
+        {
+            same = same && byte_at(back, b) == byte_at(genomes[i], b);
+            for(unsigned int k = 0; k < 8; k++)
+            {
+                same = same && pop.get(b * 8 + k, i) == (((byte_at(genomes[i], b) >> k) & 1) != 0);
+            }
+        }
+    }
+    fn_CHECK(same);
+}
+
+fn_TEST(bitslice, in_place_crossover_and_mask)
+{
+    const uint_fast32_t kBytes = 8;
+    std::vector<CharDna> ga = make_genomes(70, kBytes);
+    std::vector<CharDna> gb = make_genomes(70, kBytes);
+    for(CharDna& g : gb)
+    {
+        for(uint_fast32_t i = 0; i < g.len(); i++)
+        {
+            g.set_char(i, static_cast<char>(g.char_data(i) ^ 0x5a));
+        }
+    }
+    BitSlicedPopulation a = BitSlicedPopulation::from_genomes(views(ga), kBytes);
+    BitSlicedPopulation b = BitSlicedPopulation::from_genomes(views(gb), kBytes);
+    BitSlicedPopulation mask(kBytes * 8, ga.size());
+    for(size_t i = 0; i < ga.size(); i++)
+    {
+        for(uint_fast32_t j = 0; j < mask.bits(); j++)
+        {
+            mask.set(j, i, (i + j) % 3 == 0);
+        }
+    }
+    BitSlicedPopulation child(kBytes * 8, ga.size());
+    child.uniform_crossover(a, b, mask);
+    BitSlicedPopulation in_place = a;
+    in_place.uniform_crossover(in_place, b, mask);
+    bool same = true;
+    for(size_t i = 0; i < ga.size(); i++)
+    {
+        for(uint_fast32_t j = 0; j < mask.bits(); j++)
+        {
+            bool want = mask.get(j, i) ? a.get(j, i) : b.get(j, i);
+            same = same && child.get(j, i) == want && in_place.get(j, i) == want;
+        }
+    }
+    fn_CHECK(same);
+    //Masking twice restores the original.
+    BitSlicedPopulation flipped = a;
+    flipped.apply_mask(mask);
+    flipped.apply_mask(mask);
+    bool restored = true;
+    for(size_t i = 0; i < ga.size(); i++)
+    {
+        for(uint_fast32_t j = 0; j < mask.bits(); j++)
+        {
+            restored = restored && flipped.get(j, i) == a.get(j, i);
+        }
+    }
+    fn_CHECK(restored);
+}
+
+fn_TEST(bitslice, allele_counts_match_recount)
+{
+    const uint_fast32_t kBytes = 6;
+    std::vector<CharDna> genomes = make_genomes(200, kBytes);
+    BitSlicedPopulation pop = BitSlicedPopulation::from_genomes(views(genomes), kBytes);
+    pop.mutate(2, 5);
+    std::vector<uint_fast64_t> counts = pop.allele_counts();
+    fn_CHECK(counts.size() == kBytes * 8);
+    bool same = true;
+    for(uint_fast32_t j = 0; j < kBytes * 8 && j < counts.size(); j++)
+    {
+        uint_fast64_t c = 0;
+        for(size_t i = 0; i < pop.individuals(); i++)
+        {
+            c += pop.get(j, i) ? 1 : 0;
+        }
+        same = same && counts[j] == c;
+    }
+    fn_CHECK(same);
+}
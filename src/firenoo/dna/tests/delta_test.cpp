@@ -0,0 +1,101 @@
+#include <stdint.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../delta_dna.h"
+#include "../genome_init.h"
+#include "test.h"
+
+//Offspring are checked against a plain byte string built from the same
+//crossover points and patches.
+
+namespace
+{
+
+CharDna random_genome(uint_fast64_t seed, uint_fast32_t len)
+{
+    CharDna g(seed, 0);
+    random_fill(g, len);
+    return g;
+}
+
+bool equals(const CharDna& g, const std::string& bytes)
+{
+    return g.len() == bytes.size() && std::string(g.all_data(), g.len()) == bytes;
+}
+
+char model_byte(const std::string& bytes, uint_fast32_t i)
+{
+    return i < bytes.size() ? bytes[i] : 0;
+}
+
+} //namespace
+
+fn_TEST(delta, offspring_match_dense_crossover)
+{
+    std::mt19937_64 rng(3);
+    CharDna pa = random_genome(1, 300);
+    CharDna pb = random_genome(2, 250);
+    DeltaDna::Ptr a = DeltaDna::from_genome(pa);
+    DeltaDna::Ptr b = DeltaDna::from_genome(pb);
+    std::string ma(pa.all_data(), pa.len());
+    std::string mb(pb.all_data(), pb.len());
+    bool same = true;
+    //Chains of offspring, deeper than kMaxDepth so some get flattened.
+    for(unsigned int gen = 0; gen < 20; gen++)
+    {
+        uint_fast32_t len = 200 + static_cast<uint_fast32_t>(rng() % 150);
+        std::vector<uint_fast32_t> points;
+        for(unsigned int p = 0; p < 3; p++)
+        {
+            points.push_back(static_cast<uint_fast32_t>(rng() % len));
+        }
+        std::sort(points.begin(), points.end());
+        std::vector<DnaPatch> patches(2);
+        for(DnaPatch& p : patches)
+        {
+            p.offset = static_cast<uint_fast32_t>(rng() % (len - 8));
+            p.bytes.assign(1 + rng() % 8, static_cast<char>(rng()));
+        }
+        DeltaDna::Ptr child = DeltaDna::offspring(gen, len, a, b, points, patches, 4);
+        std::string mc(len, 0);
+        for(uint_fast32_t i = 0; i < len; i++)
+        {
+            size_t crossed = std::upper_bound(points.begin(), points.end(), i) - points.begin();
+            mc[i] = crossed % 2 == 1 ? model_byte(mb, i) : model_byte(ma, i);
+        }
+        for(const DnaPatch& p : patches)
+        {
+            for(size_t k = 0; k < p.bytes.size() && p.offset + k < len; k++)
+            {
+                mc[p.offset + k] = p.bytes[k];
+            }
+        }
+        same = same && child->len() == len && child->depth() <= 4;
+        same = same && equals(child->materialize(), mc);
+        for(uint_fast32_t i = 0; i < len; i += 7)
+        {
+            same = same && child->char_data(i) == mc[i];
+        }
+        a = b;
+        ma = mb;
+        b = child;
+        mb = mc;
+    }
+    fn_CHECK(same);
+}
+
+fn_TEST(delta, mutation_only_child)
+{
+    CharDna pa = random_genome(4, 64);
+    DeltaDna::Ptr a = DeltaDna::from_genome(pa);
+    DnaPatch patch{10, std::vector<char>(3, 'x')};
+    DeltaDna::Ptr child = DeltaDna::offspring(5, 64, a, nullptr, {}, {patch});
+    std::string want(pa.all_data(), pa.len());
+    want.replace(10, 3, "xxx");
+    CharDna flat = child->materialize();
+    fn_CHECK(equals(flat, want));
+    fn_CHECK(flat.seed() == 5);
+}
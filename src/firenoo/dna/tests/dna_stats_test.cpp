@@ -0,0 +1,73 @@
+#include <stdint.h>
+#include <utility>
+
+#include "../char_dna.h"
+#include "test.h"
+
+//Built with fn_DNA_STATS on, whatever TYPEDDNA_STATS says, so the counters
+//are always checked. Only inline CharDna code runs here, so the library's
+//own build of DnaStats is never mixed in.
+
+fn_TEST(stats, counts_char_dna_operations)
+{
+    const uint_fast64_t kUnit = CharDna::unit_size;
+    DnaStats::reset();
+    DnaStatsSnapshot base = DnaStats::snapshot();
+    fn_CHECK(DnaStats::enabled);
+    fn_CHECK(base.allocations == 0 && base.copy_constructions == 0);
+    {
+        //One unit, ten bytes copied in.
+        CharDna a(1, 10, "abcdefghij");
+        DnaStatsSnapshot s = DnaStats::snapshot();
+        fn_CHECK(s.allocations == 1 && s.reallocs == 0);
+        fn_CHECK(s.bytes_allocated == kUnit && s.bytes_copied == 10);
+        fn_CHECK(s.live_capacity == base.live_capacity + kUnit);
+        fn_CHECK(s.live_len == base.live_len + 10);
+
+        //A copy allocates and copies the whole buffer.
+        CharDna b(a);
+        s = DnaStats::snapshot();
+        fn_CHECK(s.allocations == 2 && s.copy_constructions == 1);
+        fn_CHECK(s.bytes_allocated == 2 * kUnit && s.bytes_copied == 10 + kUnit);
+        fn_CHECK(s.live_len == base.live_len + 20);
+
+        //Past capacity: reallocates to twice the offset, copying the used bytes.
+        b.set_char(static_cast<uint_fast32_t>(kUnit + 5), 'x');
+        uint_fast64_t grown = CharDna::round_up(static_cast<uint_fast32_t>((kUnit + 6) * 2));
+        s = DnaStats::snapshot();
+        fn_CHECK(s.allocations == 3 && s.reallocs == 1);
+        fn_CHECK(s.bytes_allocated == 2 * kUnit + grown && s.bytes_copied == 20 + kUnit);
+        fn_CHECK(b.capacity() == grown);
+        fn_CHECK(s.live_capacity == base.live_capacity + kUnit + grown);
+        fn_CHECK(s.live_len == base.live_len + 10 + kUnit + 6);
+        fn_CHECK(s.peak_capacity == s.live_capacity + kUnit);
+
+        //Shrinking only changes the length; growing past capacity reallocates.
+        b.resize(4);
+        s = DnaStats::snapshot();
+        fn_CHECK(s.reallocs == 1 && s.live_len == base.live_len + 14);
+        b.resize(static_cast<uint_fast32_t>(grown + 1));
+        s = DnaStats::snapshot();
+        fn_CHECK(s.reallocs == 2 && s.allocations == 4);
+        fn_CHECK(s.bytes_copied == 24 + kUnit);
+        fn_CHECK(s.live_len == base.live_len + 10 + grown + 1);
+        fn_CHECK(s.live_capacity == base.live_capacity + kUnit + b.capacity());
+
+        //Move-assign frees the target's buffer and allocates nothing.
+        CharDna c(2, 0);
+        s = DnaStats::snapshot();
+        fn_CHECK(s.allocations == 5);
+        a = std::move(c);
+        s = DnaStats::snapshot();
+        fn_CHECK(s.allocations == 5 && s.copy_constructions == 1);
+        fn_CHECK(s.live_capacity == base.live_capacity + b.capacity());
+        fn_CHECK(s.live_len == base.live_len + grown + 1);
+    }
+    //Everything is freed again.
+    DnaStatsSnapshot end = DnaStats::snapshot();
+    fn_CHECK(end.live_capacity == base.live_capacity && end.live_len == base.live_len);
+    fn_CHECK(end.slack() == base.slack());
+    DnaStats::reset();
+    end = DnaStats::snapshot();
+    fn_CHECK(end.allocations == 0 && end.bytes_copied == 0 && end.peak_capacity == end.live_capacity);
+}
@@ -0,0 +1,76 @@
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "../fitness_cache.h"
+#include "test.h"
+
+namespace
+{
+
+CharDna genome(uint_fast64_t seed, char fill)
+{
+    return CharDna(seed, 8, std::string(8, fill).c_str());
+}
+
+} //namespace
+
+fn_TEST(cache, hit_miss_and_clear)
+{
+    FitnessCache cache(64);
+    CharDna a = genome(1, 'a');
+    double f = 0;
+    fn_CHECK(!cache.lookup(a, f));
+    cache.insert(a, 3.5);
+    fn_CHECK(cache.lookup(a, f) && f == 3.5);
+    //Same bytes under another seed is another genome.
+    fn_CHECK(!cache.lookup(genome(2, 'a'), f));
+    cache.insert(a, 4.5);
+    fn_CHECK(cache.lookup(a, f) && f == 4.5);
+    fn_CHECK(cache.size() == 1);
+    fn_CHECK(cache.hits() == 2 && cache.misses() == 2);
+    cache.clear();
+    fn_CHECK(cache.size() == 0);
+    fn_CHECK(cache.hits() == 0 && cache.misses() == 0);
+    fn_CHECK(!cache.lookup(a, f));
+}
+
+fn_TEST(cache, evicts_least_recently_used)
+{
+    //One shard, so the capacity is exact.
+    FitnessCache cache(3, false, 1);
+    fn_CHECK(cache.capacity() == 3);
+    std::vector<CharDna> g;
+    for(char c = 'a'; c < 'e'; c++)
+    {
+        g.push_back(genome(1, c));
+    }
+    double f = 0;
+    cache.insert(g[0], 0);
+    cache.insert(g[1], 1);
+    cache.insert(g[2], 2);
+    //Touch g[0], so g[1] is now the oldest.
+    fn_CHECK(cache.lookup(g[0], f));
+    cache.insert(g[3], 3);
+    fn_CHECK(cache.size() == 3);
+    fn_CHECK(!cache.lookup(g[1], f));
+    fn_CHECK(cache.lookup(g[0], f) && f == 0);
+    fn_CHECK(cache.lookup(g[2], f) && f == 2);
+    fn_CHECK(cache.lookup(g[3], f) && f == 3);
+}
+
+fn_TEST(cache, verify_rejects_colliding_key)
+{
+    FitnessCache plain(16);
+    FitnessCache verified(16, true);
+    CharDna a = genome(1, 'a');
+    CharDna b = genome(1, 'b');
+    //Store a's score under b's key, as a hash collision would.
+    DnaHash128 key = FitnessCache::key(b);
+    plain.insert(key, a, 1.0);
+    verified.insert(key, a, 1.0);
+    double f = 0;
+    fn_CHECK(plain.lookup(key, b, f) && f == 1.0);
+    fn_CHECK(!verified.lookup(key, b, f));
+    fn_CHECK(verified.lookup(key, a, f) && f == 1.0);
+}
@@ -0,0 +1,153 @@
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include "../genome_init.h"
+#include "test.h"
+
+namespace
+{
+
+uint64_t load_le(const char* p, unsigned int width)
+{
+    uint64_t v = 0;
+    for(unsigned int b = 0; b < width; b++)
+    {
+        v |= static_cast<uint64_t>(static_cast<unsigned char>(p[b])) << (8 * b);
+    }
+    return v;
+}
+
+//Every field of every genome in its range.
+bool in_range(const char* genome, const GenomeSchema& schema)
+{
+    for(const GenomeSchema::Field& f : schema.fields())
+    {
+        uint64_t v = load_le(genome + f.offset, f.width);
+        if(v < f.lo || v > f.hi)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<uint_fast64_t> make_seeds(size_t n)
+{
+    std::vector<uint_fast64_t> seeds(n);
+    for(size_t i = 0; i < n; i++)
+    {
+        seeds[i] = i * 7919 + 1;
+    }
+    return seeds;
+}
+
+} //namespace
+
+fn_TEST(schema, layout_aligns_and_clamps)
+{
+    GenomeSchema schema;
+    fn_CHECK(schema.add(fn_BYTE, 3, 9) == 0);
+    fn_CHECK(schema.add(fn_INT, 0, 1000) == 4);
+    fn_CHECK(schema.add(fn_SHORT, 10, 1ull << 40) == 8);
+    fn_CHECK(schema.add(fn_LONG, 5, 5) == 16);
+    //Invalid width: one byte, and lo above hi is pulled down to hi.
+    fn_CHECK(schema.add(3, 200, 100) == 24);
+    fn_CHECK(schema.bytes() == 25);
+    const std::vector<GenomeSchema::Field>& f = schema.fields();
+    fn_CHECK(f.size() == 5);
+    if(f.size() == 5)
+    {
+        fn_CHECK(f[2].hi == 0xffff);
+        fn_CHECK(f[4].width == fn_BYTE && f[4].lo == 100 && f[4].hi == 100);
+    }
+}
+
+fn_TEST(schema, values_fall_in_range)
+{
+    GenomeSchema schema;
+    schema.add(fn_BYTE, 3, 9);
+    schema.add(fn_SHORT, 1000, 1001);
+    schema.add(fn_INT, 0, 1000000);
+    schema.add(fn_LONG, 1ull << 60, (1ull << 60) + 12345);
+    schema.add(fn_LONG, 0, UINT64_MAX);
+    schema.add(fn_LONG, 7, UINT64_MAX - 3);
+    std::vector<uint_fast64_t> seeds = make_seeds(2000);
+    std::vector<CharDna> pop = random_population(seeds, schema.bytes() + 3, &schema);
+    bool ok = pop.size() == seeds.size();
+    bool lo_seen = false;
+    bool hi_seen = false;
+    for(size_t i = 0; i < pop.size(); i++)
+    {
+        ok = ok && pop[i].seed() == seeds[i] && pop[i].len() == schema.bytes() + 3;
+        ok = ok && in_range(pop[i].all_data(), schema);
+        uint64_t v = load_le(pop[i].all_data() + 2, 2);
+        lo_seen = lo_seen || v == 1000;
+        hi_seen = hi_seen || v == 1001;
+    }
+    fn_CHECK(ok);
+    //A two-value range produces both values.
+    fn_CHECK(lo_seen && hi_seen);
+}
+
+fn_TEST(schema, short_len_is_raised)
+{
+    GenomeSchema schema;
+    schema.add(fn_LONG, 1, 2);
+    schema.add(fn_LONG, 1, 2);
+    std::vector<CharDna> pop = random_population(make_seeds(10), 4, &schema);
+    bool ok = true;
+    for(const CharDna& g : pop)
+    {
+        ok = ok && g.len() == schema.bytes() && in_range(g.all_data(), schema);
+    }
+    fn_CHECK(ok);
+}
+
+fn_TEST(schema, slab_matches_population)
+{
+    GenomeSchema schema;
+    schema.add(fn_INT, 10, 20);
+    schema.add(fn_BYTE, 0, 1);
+    const size_t kStride = 32;
+    const uint_fast32_t kLen = 24;
+    std::vector<uint_fast64_t> seeds = make_seeds(50);
+    std::vector<char> slab(seeds.size() * kStride, 'z');
+    fn_CHECK(random_slab(slab.data(), kStride, seeds, kLen, &schema) == 1);
+    std::vector<CharDna> pop = random_population(seeds, kLen, &schema);
+    bool same = true;
+    for(size_t i = 0; i < seeds.size(); i++)
+    {
+        const char* g = slab.data() + i * kStride;
+        same = same && memcmp(g, pop[i].all_data(), kLen) == 0;
+        //The rest of the stride is untouched.
+        for(size_t b = kLen; b < kStride; b++)
+        {
+            same = same && g[b] == 'z';
+        }
+    }
+    fn_CHECK(same);
+    //Too short for the schema, or longer than the stride: nothing written.
+    std::vector<char> untouched(slab.size(), 'z');
+    fn_CHECK(random_slab(untouched.data(), kStride, seeds, 3, &schema) == 0);
+    fn_CHECK(random_slab(untouched.data(), kStride, seeds, kStride + 1, nullptr) == 0);
+    fn_CHECK(untouched == std::vector<char>(slab.size(), 'z'));
+}
+
+fn_TEST(init, stream_depends_only_on_seed)
+{
+    //Lengths around the 32-byte step, so the vector path and the tail agree.
+    std::vector<char> full(1000);
+    random_fill(full.data(), full.size(), 42);
+    bool prefix = true;
+    for(size_t len : {size_t(1), size_t(31), size_t(32), size_t(33), size_t(64), size_t(999)})
+    {
+        std::vector<char> part(len);
+        random_fill(part.data(), len, 42);
+        prefix = prefix && memcmp(part.data(), full.data(), len) == 0;
+    }
+    fn_CHECK(prefix);
+    std::vector<char> other(1000);
+    random_fill(other.data(), other.size(), 43);
+    fn_CHECK(other != full);
+}
@@ -0,0 +1,89 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "../genome_store.h"
+#include "test.h"
+
+namespace
+{
+
+std::string load_file(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void save_file(const std::string& path, const std::string& bytes)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+} //namespace
+
+fn_TEST(store, interning_counts_references)
+{
+    GenomeStore store;
+    CharDna a(1, 4, "same");
+    CharDna b(2, 4, "same");
+    CharDna c(3, 5, "other");
+    uint_fast64_t ia = store.intern(a);
+    uint_fast64_t ib = store.intern(b);
+    uint_fast64_t ic = store.intern(c);
+    fn_CHECK(ia == ib);
+    fn_CHECK(ia != ic);
+    fn_CHECK(store.refs(ia) == 2 && store.refs(ic) == 1);
+    fn_CHECK(store.payloads() == 2 && store.bytes() == 9 && store.hits() == 1);
+    store.retain(ic);
+    fn_CHECK(!store.release(ic));
+    fn_CHECK(store.release(ic));
+    fn_CHECK(store.payloads() == 1 && store.bytes() == 4);
+    CharDna back = store.materialize(ia, 77);
+    fn_CHECK(back.seed() == 77 && std::string(back.all_data(), back.len()) == "same");
+    fn_CHECK(!store.release(ia));
+    fn_CHECK(store.release(ia));
+    fn_CHECK(store.payloads() == 0 && store.bytes() == 0);
+    //Freed ids are reused.
+    uint_fast64_t id = store.intern(c);
+    fn_CHECK(id == ia || id == ic);
+    fn_CHECK(store.len(id) == 5 && std::string(store.data(id), 5) == "other");
+}
+
+fn_TEST(store, records_round_trip)
+{
+    std::string path = dna_test::temp_path("store.bin");
+    GenomeStore store;
+    std::vector<StoredGenome> genomes;
+    for(uint_fast64_t i = 0; i < 30; i++)
+    {
+        std::string bytes(16, static_cast<char>('a' + i % 4));
+        genomes.push_back(StoredGenome{i, store.intern(bytes.data(), 16)});
+    }
+    fn_CHECK(write_store_records(path, store, genomes) == 1);
+    GenomeStore loaded;
+    std::vector<StoredGenome> back;
+    fn_CHECK(read_store_records(path, loaded, back) == 1);
+    fn_CHECK(back.size() == genomes.size());
+    fn_CHECK(loaded.payloads() == 4);
+    bool same = back.size() == genomes.size();
+    for(size_t i = 0; i < back.size() && same; i++)
+    {
+        same = back[i].seed == genomes[i].seed && loaded.refs(back[i].id) == store.refs(genomes[i].id)
+            && std::string(loaded.data(back[i].id), 16) == std::string(store.data(genomes[i].id), 16);
+    }
+    fn_CHECK(same);
+
+    //A read that fails part way keeps no references.
+    std::string good = load_file(path);
+    save_file(path, good.substr(0, good.size() - 8));
+    GenomeStore partial;
+    std::vector<StoredGenome> kept(1, StoredGenome{0, 0});
+    fn_CHECK(read_store_records(path, partial, kept) == 0);
+    fn_CHECK(partial.payloads() == 0 && partial.bytes() == 0);
+    fn_CHECK(kept.size() == 1);
+    remove(path.c_str());
+}
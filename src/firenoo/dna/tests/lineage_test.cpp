@@ -0,0 +1,146 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../lineage.h"
+#include "test.h"
+
+namespace
+{
+
+//Two generations over three founders:
+//  3 = 0 x 1, 4 = mutation of 1, 5 = clone of 2, 6 = 3 x 4, 7 = 3 x 5.
+void build_pedigree(LineageLog& log)
+{
+    log.founder(0);
+    log.founder(0);
+    log.founder(0);
+    log.record(0, 1, LINEAGE_CROSSOVER, 1);
+    log.record(1, LineageLog::kNone, LINEAGE_MUTATION, 1);
+    log.record(2, LineageLog::kNone, LINEAGE_CLONE, 1);
+    log.record(3, 4, LINEAGE_CROSSOVER, 2);
+    log.record(3, 5, LINEAGE_CROSSOVER, 2);
+}
+
+bool near(double a, double b)
+{
+    return a - b < 1e-12 && b - a < 1e-12;
+}
+
+} //namespace
+
+fn_TEST(lineage, pedigree_queries)
+{
+    LineageLog log;
+    build_pedigree(log);
+    fn_CHECK(log.size() == 8);
+    fn_CHECK(log.parent_a(6) == 3 && log.parent_b(6) == 4);
+    fn_CHECK(log.op(4) == LINEAGE_MUTATION && log.generation(7) == 2);
+    fn_CHECK(log.ancestors(6) == std::vector<uint64_t>({0, 1, 3, 4}));
+    fn_CHECK(log.ancestors(7) == std::vector<uint64_t>({0, 1, 2, 3, 5}));
+    fn_CHECK(log.ancestors(0).empty());
+    fn_CHECK(log.descendants(1) == std::vector<uint64_t>({3, 4, 6, 7}));
+    fn_CHECK(log.descendants(2) == std::vector<uint64_t>({5, 7}));
+    fn_CHECK(log.descendants(7).empty());
+    fn_CHECK(near(log.contribution(0, 2), 0.25));
+    fn_CHECK(near(log.contribution(1, 2), 0.5));
+    fn_CHECK(near(log.contribution(2, 2), 0.25));
+    fn_CHECK(near(log.contribution(0, 0), 1.0 / 3));
+    fn_CHECK(log.contribution(0, 5) == 0.0);
+}
+
+fn_TEST(lineage, unknown_ids)
+{
+    LineageLog log;
+    build_pedigree(log);
+    fn_CHECK(log.record(8, LineageLog::kNone, LINEAGE_MUTATION, 3) == LineageLog::kNone);
+    fn_CHECK(log.record(LineageLog::kNone, 100, LINEAGE_MUTATION, 3) == LineageLog::kNone);
+    fn_CHECK(log.size() == 8);
+    fn_CHECK(log.ancestors(8).empty());
+    fn_CHECK(log.descendants(100).empty());
+    fn_CHECK(log.contribution(LineageLog::kNone, 2) == 0.0);
+}
+
+//Ancestor and descendant sets against a plain graph walk.
+fn_TEST(lineage, random_pedigree_matches_walk)
+{
+    std::mt19937_64 rng(5);
+    LineageLog log;
+    for(unsigned int i = 0; i < 20; i++)
+    {
+        log.founder(0);
+    }
+    for(uint32_t gen = 1; gen < 30; gen++)
+    {
+        uint64_t end = log.size();
+        for(unsigned int i = 0; i < 20; i++)
+        {
+            uint64_t a = end - 1 - rng() % 20;
+            uint64_t b = end - 1 - rng() % 20;
+            log.record(a, rng() % 2 == 0 ? b : LineageLog::kNone, LINEAGE_CROSSOVER, gen);
+        }
+    }
+    bool same = true;
+    for(uint64_t id = 0; id < log.size(); id += 37)
+    {
+        std::set<uint64_t> up;
+        std::vector<uint64_t> stack(1, id);
+        while(!stack.empty())
+        {
+            uint64_t i = stack.back();
+            stack.pop_back();
+            for(uint64_t p : {log.parent_a(i), log.parent_b(i)})
+            {
+                if(p != LineageLog::kNone && up.insert(p).second)
+                {
+                    stack.push_back(p);
+                }
+            }
+        }
+        same = same && log.ancestors(id) == std::vector<uint64_t>(up.begin(), up.end());
+        std::vector<uint64_t> down;
+        for(uint64_t j = id + 1; j < log.size(); j++)
+        {
+            std::vector<uint64_t> anc = log.ancestors(j);
+            if(std::set<uint64_t>(anc.begin(), anc.end()).count(id) != 0)
+            {
+                down.push_back(j);
+            }
+        }
+        same = same && log.descendants(id) == down;
+    }
+    fn_CHECK(same);
+}
+
+fn_TEST(lineage, save_and_load)
+{
+    std::string path = dna_test::temp_path("lineage.bin");
+    LineageLog log;
+    build_pedigree(log);
+    fn_CHECK(log.save(path) == 1);
+    LineageLog back;
+    fn_CHECK(back.load(path) == 1);
+    fn_CHECK(back.size() == log.size());
+    bool same = back.size() == log.size();
+    for(uint64_t i = 0; i < log.size() && same; i++)
+    {
+        same = back.parent_a(i) == log.parent_a(i) && back.parent_b(i) == log.parent_b(i)
+            && back.op(i) == log.op(i) && back.generation(i) == log.generation(i);
+    }
+    fn_CHECK(same);
+    //Truncated files leave the log empty.
+    std::ifstream in(path, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 3));
+    out.close();
+    fn_CHECK(back.load(path) == 0);
+    fn_CHECK(back.size() == 0);
+    remove(path.c_str());
+}
@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../numa.h"
+#include "test.h"
+
+namespace
+{
+
+//A fake /sys/devices/system/node: online lists the nodes, and each entry of
+//cpulists is the cpulist of node i (empty for none).
+std::string fake_sysfs(const std::string& name, const char* online, const std::vector<const char*>& cpulists)
+{
+    std::filesystem::path dir = dna_test::temp_path(name);
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    if(online != nullptr)
+    {
+        std::ofstream(dir / "online") << online << '\n';
+    }
+    for(size_t i = 0; i < cpulists.size(); i++)
+    {
+        if(cpulists[i] == nullptr)
+        {
+            continue;
+        }
+        std::filesystem::path node = dir / ("node" + std::to_string(i));
+        std::filesystem::create_directories(node);
+        std::ofstream(node / "cpulist") << cpulists[i] << '\n';
+    }
+    return dir.string();
+}
+
+} //namespace
+
+//Node 1 is offline, node 4 has memory but no CPUs.
+fn_TEST(numa, topology_skips_gaps)
+{
+    std::string dir = fake_sysfs("numa_gaps", "0,2-4", {"0-1", "2-3", "4,6", "8-9", ""});
+    NumaTopology topo(dir);
+    fn_CHECK(topo.nodes() == 3);
+    if(topo.nodes() == 3)
+    {
+        fn_CHECK(topo.id(0) == 0 && topo.id(1) == 2 && topo.id(2) == 3);
+        fn_CHECK(topo.cpus(0) == std::vector<unsigned int>({0, 1}));
+        fn_CHECK(topo.cpus(1) == std::vector<unsigned int>({4, 6}));
+        fn_CHECK(topo.cpus(2) == std::vector<unsigned int>({8, 9}));
+    }
+    std::filesystem::remove_all(dir);
+}
+
+fn_TEST(numa, single_node_fallback)
+{
+    unsigned int cpus = std::max(1u, std::thread::hardware_concurrency());
+    //No online or possible list: node directories alone are not trusted.
+    std::string dir = fake_sysfs("numa_none", nullptr, {"0-3", "4-7"});
+    NumaTopology topo(dir);
+    fn_CHECK(topo.nodes() == 1 && topo.id(0) == 0);
+    fn_CHECK(topo.cpus(0).size() == cpus);
+    std::filesystem::remove_all(dir);
+    NumaTopology missing(dna_test::temp_path("numa_missing"));
+    fn_CHECK(missing.nodes() == 1 && missing.cpus(0).size() == cpus);
+    fn_CHECK(NumaTopology::get().nodes() >= 1);
+
+    NumaWorkerPool pool(5, missing);
+    fn_CHECK(pool.size() == 5 && pool.workers_on(0) == 5);
+    bool ranks = true;
+    for(unsigned int w = 0; w < pool.size(); w++)
+    {
+        ranks = ranks && pool.node_of(w) == 0 && pool.rank_on_node(w) == w;
+    }
+    fn_CHECK(ranks);
+}
+
+fn_TEST(numa, pool_places_round_robin)
+{
+    std::string dir = fake_sysfs("numa_pool", "0,2-3", {"0", nullptr, "1", "2-3"});
+    NumaTopology topo(dir);
+    std::filesystem::remove_all(dir);
+    fn_CHECK(topo.nodes() == 3);
+    NumaWorkerPool pool(8, topo);
+    fn_CHECK(pool.size() == 8);
+    fn_CHECK(pool.workers_on(0) == 3 && pool.workers_on(1) == 3 && pool.workers_on(2) == 2);
+    fn_CHECK(pool.workers_on(3) == 0);
+    bool placed = true;
+    for(unsigned int w = 0; w < pool.size(); w++)
+    {
+        placed = placed && pool.node_of(w) == w % 3 && pool.rank_on_node(w) == w / 3;
+    }
+    fn_CHECK(placed);
+    //Every worker runs the task once per run(), with its own node.
+    std::vector<std::atomic<unsigned int>> calls(pool.size());
+    std::atomic<unsigned int> wrong_node(0);
+    for(unsigned int round = 0; round < 3; round++)
+    {
+        pool.run([&](unsigned int worker, unsigned int node) {
+            calls[worker]++;
+            if(node != pool.node_of(worker))
+            {
+                wrong_node++;
+            }
+        });
+    }
+    bool all = true;
+    for(std::atomic<unsigned int>& c : calls)
+    {
+        all = all && c.load() == 3;
+    }
+    fn_CHECK(all);
+    fn_CHECK(wrong_node.load() == 0);
+    //Default size is one worker per CPU.
+    NumaWorkerPool full(0, topo);
+    fn_CHECK(full.size() == 4);
+}
@@ -0,0 +1,122 @@
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+#include "../phase_timing.h"
+#include "test.h"
+
+namespace
+{
+
+//Within the 1/16 a bucket allows.
+bool close_to(uint_fast64_t got, uint_fast64_t want)
+{
+    uint_fast64_t diff = got > want ? got - want : want - got;
+    return diff * LatencyHistogram::kSub <= want;
+}
+
+} //namespace
+
+fn_TEST(timing, buckets_are_exact_below_sixteen)
+{
+    LatencyHistogram h;
+    fn_CHECK(h.count() == 0 && h.percentile(0.5) == 0 && h.mean() == 0.0);
+    for(uint_fast64_t v = 0; v < LatencyHistogram::kSub; v++)
+    {
+        h.record(v);
+    }
+    bool exact = true;
+    for(uint_fast64_t v = 0; v < LatencyHistogram::kSub; v++)
+    {
+        exact = exact && h.percentile(static_cast<double>(v) / LatencyHistogram::kSub) == v;
+    }
+    fn_CHECK(exact);
+    fn_CHECK(h.percentile(1.0) == LatencyHistogram::kSub - 1);
+    fn_CHECK(h.max() == LatencyHistogram::kSub - 1);
+}
+
+fn_TEST(timing, bucket_bounds_are_log_linear)
+{
+    bool ordered = true;
+    for(unsigned int i = 1; i < LatencyHistogram::kBuckets; i++)
+    {
+        ordered = ordered && LatencyHistogram::bucket_low(i) > LatencyHistogram::bucket_low(i - 1);
+    }
+    fn_CHECK(ordered);
+    fn_CHECK(LatencyHistogram::bucket_low(LatencyHistogram::kSub) == LatencyHistogram::kSub);
+    //Each power of two from 16 up is split into 16 equal buckets.
+    fn_CHECK(LatencyHistogram::bucket_low(2 * LatencyHistogram::kSub) == 32);
+    fn_CHECK(LatencyHistogram::bucket_low(2 * LatencyHistogram::kSub + 1) == 34);
+    fn_CHECK(LatencyHistogram::bucket_low(LatencyHistogram::kBuckets - 1) == 31ull << 59);
+    //A single value reads back within 1/16, and never above itself.
+    bool close = true;
+    for(uint_fast64_t v = 16; v < (1ull << 40); v = v * 3 + 7)
+    {
+        LatencyHistogram one;
+        one.record(v);
+        uint_fast64_t p = one.percentile(0.5);
+        close = close && p <= v && close_to(p, v);
+    }
+    fn_CHECK(close);
+    //The last bucket has no upper bound and reports its low end.
+    LatencyHistogram top;
+    top.record(UINT64_MAX);
+    fn_CHECK(top.percentile(0.5) == 31ull << 59 && top.max() == UINT64_MAX);
+}
+
+fn_TEST(timing, percentiles_and_merge)
+{
+    LatencyHistogram a;
+    LatencyHistogram b;
+    for(uint_fast64_t v = 1; v <= 1000; v++)
+    {
+        (v % 2 == 0 ? a : b).record(v);
+    }
+    LatencyHistogram h(a);
+    h.merge(b);
+    fn_CHECK(h.count() == 1000 && h.max() == 1000);
+    fn_CHECK(h.mean() == 500.5);
+    fn_CHECK(close_to(h.percentile(0.5), 500));
+    fn_CHECK(close_to(h.percentile(0.99), 990));
+    fn_CHECK(h.percentile(0.0) == 1);
+    fn_CHECK(h.percentile(1.0) == 1000);
+    //Copies are independent of the original.
+    a.clear();
+    fn_CHECK(a.count() == 0 && h.count() == 1000);
+    a = h;
+    fn_CHECK(a.count() == 1000 && a.percentile(0.5) == h.percentile(0.5));
+}
+
+//Samples of threads that have exited are kept in the retired set.
+fn_TEST(timing, exited_threads_are_merged)
+{
+    const unsigned int kRounds = 20;
+    const unsigned int kThreads = 8;
+    const unsigned int kSamples = 100;
+    PhaseTimings::reset();
+    for(unsigned int round = 0; round < kRounds; round++)
+    {
+        std::vector<std::thread> threads;
+        for(unsigned int t = 0; t < kThreads; t++)
+        {
+            threads.emplace_back([]() {
+                for(unsigned int i = 0; i < kSamples; i++)
+                {
+                    PhaseTimings::record_ticks(PHASE_MUTATION, i);
+                }
+            });
+        }
+        for(std::thread& t : threads)
+        {
+            t.join();
+        }
+    }
+    LatencyHistogram h = PhaseTimings::merged(PHASE_MUTATION);
+    fn_CHECK(h.count() == kRounds * kThreads * kSamples);
+    fn_CHECK(PhaseTimings::merged(PHASE_CROSSOVER).count() == 0);
+    //A live thread's samples are merged too.
+    PhaseTimings::record_ticks(PHASE_MUTATION, 1);
+    fn_CHECK(PhaseTimings::merged(PHASE_MUTATION).count() == kRounds * kThreads * kSamples + 1);
+    PhaseTimings::reset();
+    fn_CHECK(PhaseTimings::merged(PHASE_MUTATION).count() == 0);
+}
@@ -0,0 +1,180 @@
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "../bounded_queue.h"
+#include "../pipeline.h"
+#include "test.h"
+
+fn_TEST(queue, try_push_and_pop_respect_capacity)
+{
+    BoundedQueue<int> q(3);
+    //Rounded up to 4.
+    for(int i = 0; i < 4; i++)
+    {
+        fn_CHECK(q.try_push(i));
+    }
+    fn_CHECK(!q.try_push(4));
+    int v = -1;
+    for(int i = 0; i < 4; i++)
+    {
+        fn_CHECK(q.try_pop(v) && v == i);
+    }
+    fn_CHECK(!q.try_pop(v));
+}
+
+fn_TEST(queue, close_drains_then_fails)
+{
+    BoundedQueue<int> q(8);
+    q.push(1);
+    q.push(2);
+    q.close();
+    int v = 0;
+    fn_CHECK(q.pop(v) && v == 1);
+    fn_CHECK(q.pop(v) && v == 2);
+    fn_CHECK(!q.pop(v));
+}
+
+//A small queue keeps producers and consumers parking on each other.
+fn_TEST(queue, mpmc_delivers_each_value_once_in_order)
+{
+    const unsigned int kProducers = 4;
+    const unsigned int kConsumers = 4;
+    const uint_fast64_t kPerProducer = 20000;
+    BoundedQueue<uint_fast64_t> q(4);
+    std::vector<std::vector<uint_fast64_t>> seen(kConsumers);
+    std::vector<std::thread> consumers;
+    for(unsigned int c = 0; c < kConsumers; c++)
+    {
+        consumers.emplace_back([&q, &seen, c]() {
+            uint_fast64_t v;
+            while(q.pop(v))
+            {
+                seen[c].push_back(v);
+            }
+        });
+    }
+    std::vector<std::thread> producers;
+    for(unsigned int p = 0; p < kProducers; p++)
+    {
+        producers.emplace_back([&q, p]() {
+            for(uint_fast64_t i = 0; i < kPerProducer; i++)
+            {
+                q.push(p * kPerProducer + i);
+            }
+        });
+    }
+    for(std::thread& t : producers)
+    {
+        t.join();
+    }
+    q.close();
+    for(std::thread& t : consumers)
+    {
+        t.join();
+    }
+    std::vector<unsigned int> count(kProducers * kPerProducer, 0);
+    bool ordered = true;
+    for(const std::vector<uint_fast64_t>& s : seen)
+    {
+        //FIFO: one consumer sees each producer's values in push order.
+        std::vector<uint_fast64_t> last(kProducers, 0);
+        std::vector<bool> any(kProducers, false);
+        for(uint_fast64_t v : s)
+        {
+            count[v]++;
+            uint_fast64_t p = v / kPerProducer;
+            if(any[p] && v <= last[p])
+            {
+                ordered = false;
+            }
+            any[p] = true;
+            last[p] = v;
+        }
+    }
+    bool once = true;
+    for(unsigned int c : count)
+    {
+        once = once && c == 1;
+    }
+    fn_CHECK(once);
+    fn_CHECK(ordered);
+}
+
+//Small batches and shallow queues, so batches are recycled many times in
+//a generation, and a pause between generations so idle stages park.
+fn_TEST(pipeline, each_genome_scored_and_bred_once)
+{
+    const uint_fast64_t kMaxGenomes = 1000;
+    std::vector<std::atomic<unsigned int>> decoded(kMaxGenomes);
+    std::vector<std::atomic<unsigned int>> scored(kMaxGenomes);
+    std::vector<std::atomic<unsigned int>> bred(kMaxGenomes);
+    std::atomic<unsigned int> out_of_order(0);
+    PipelineStages stages;
+    //Each stage checks the mark left by the one before it.
+    stages.decode = [&](GenomeBatch& b) {
+        for(uint_fast32_t k = 0; k < b.count; k++)
+        {
+            decoded[b.first + k]++;
+            b.fitness[k] = 1.0;
+        }
+    };
+    stages.fitness = [&](GenomeBatch& b) {
+        for(uint_fast32_t k = 0; k < b.count; k++)
+        {
+            if(b.fitness[k] != 1.0)
+            {
+                out_of_order++;
+            }
+            scored[b.first + k]++;
+            b.fitness[k] = static_cast<double>(b.first + k);
+        }
+    };
+    stages.select = [&](GenomeBatch& b) {
+        for(uint_fast32_t k = 0; k < b.count; k++)
+        {
+            b.selected.push_back(static_cast<uint_fast64_t>(b.fitness[k]));
+        }
+    };
+    stages.breed = [&](GenomeBatch& b) {
+        if(b.selected.size() != b.count)
+        {
+            out_of_order++;
+            return;
+        }
+        for(uint_fast32_t k = 0; k < b.count; k++)
+        {
+            if(b.selected[k] != b.first + k)
+            {
+                out_of_order++;
+            }
+            bred[b.first + k]++;
+        }
+    };
+    stages.decode_threads = 2;
+    stages.fitness_threads = 3;
+    stages.select_threads = 2;
+    stages.breed_threads = 2;
+    GenerationPipeline pipeline(stages, 7, 2);
+    for(uint_fast64_t genomes : {kMaxGenomes, uint_fast64_t(3), uint_fast64_t(0), kMaxGenomes - 1, kMaxGenomes})
+    {
+        for(uint_fast64_t i = 0; i < kMaxGenomes; i++)
+        {
+            decoded[i] = 0;
+            scored[i] = 0;
+            bred[i] = 0;
+        }
+        pipeline.run(genomes);
+        bool once = true;
+        for(uint_fast64_t i = 0; i < kMaxGenomes; i++)
+        {
+            unsigned int want = i < genomes ? 1 : 0;
+            once = once && decoded[i].load() == want && scored[i].load() == want && bred[i].load() == want;
+        }
+        fn_CHECK(once);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    fn_CHECK(out_of_order.load() == 0);
+}
@@ -0,0 +1,179 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "../genome_init.h"
+#include "../population_image.h"
+#include "test.h"
+
+namespace
+{
+
+std::string load_file(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void save_file(const std::string& path, const std::string& bytes)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+//Lengths from empty to several units, so the slab has mixed padding.
+std::vector<CharDna> make_genomes()
+{
+    std::vector<CharDna> out;
+    for(uint_fast32_t i = 0; i < 20; i++)
+    {
+        out.emplace_back(1000 + i, 0);
+        random_fill(out.back(), i * 13);
+    }
+    return out;
+}
+
+//A valid image of make_genomes() and two genes, as bytes.
+std::string image_bytes(const std::string& path, std::vector<CharDna>& genomes, std::vector<Gene>& genes)
+{
+    genomes = make_genomes();
+    std::vector<const CharDna*> views;
+    for(const CharDna& g : genomes)
+    {
+        views.push_back(&g);
+    }
+    uint_fast64_t words[2][5] = {{1, 2, 3, 4, 5}, {~0ull, 0, 7, 0, 9}};
+    genes = {Gene(words[0], 2), Gene(words[1], 5)};
+    write_population_image(path, views, genes);
+    return load_file(path);
+}
+
+PopulationImageHeader header_of(const std::string& bytes)
+{
+    PopulationImageHeader h;
+    memcpy(&h, bytes.data(), sizeof(h));
+    return h;
+}
+
+template<typename T>
+void poke(std::string& bytes, uint64_t offset, T value)
+{
+    memcpy(&bytes[offset], &value, sizeof(value));
+}
+
+} //namespace
+
+fn_TEST(image, round_trip)
+{
+    std::string path = dna_test::temp_path("image.bin");
+    std::vector<CharDna> genomes;
+    std::vector<Gene> genes;
+    image_bytes(path, genomes, genes);
+    PopulationImage image;
+    fn_CHECK(!image.is_open() && image.size() == 0);
+    fn_CHECK(image.open(path) == 1);
+    fn_CHECK(image.size() == genomes.size() && image.genes() == genes.size());
+    fn_CHECK(image.unit_size() == fn_UNIT_SIZE);
+    bool same = image.size() == genomes.size();
+    for(size_t i = 0; i < genomes.size() && same; i++)
+    {
+        same = image.seed(i) == genomes[i].seed() && image.len(i) == genomes[i].len()
+            && memcmp(image.data(i), genomes[i].all_data(), genomes[i].len()) == 0
+            && reinterpret_cast<uintptr_t>(image.data(i)) % 64 == 0;
+        CharDna back = image.to_genome(i);
+        same = same && back.seed() == genomes[i].seed()
+            && std::string(back.all_data(), back.len()) == std::string(genomes[i].all_data(), genomes[i].len());
+    }
+    fn_CHECK(same);
+    bool genes_same = image.genes() == genes.size();
+    for(size_t g = 0; g < genes.size() && genes_same; g++)
+    {
+        Gene back = image.gene(g);
+        genes_same = back.slot() == genes[g].slot()
+            && memcmp(back.get_data(), genes[g].get_data(), 5 * sizeof(uint_fast64_t)) == 0;
+    }
+    fn_CHECK(genes_same);
+    remove(path.c_str());
+}
+
+fn_TEST(image, truncated_file_is_rejected)
+{
+    std::string path = dna_test::temp_path("image_cut.bin");
+    std::vector<CharDna> genomes;
+    std::vector<Gene> genes;
+    std::string good = image_bytes(path, genomes, genes);
+    bool all_failed = true;
+    for(size_t cut = 0; cut < good.size(); cut += 61)
+    {
+        save_file(path, good.substr(0, cut));
+        PopulationImage image;
+        all_failed = all_failed && image.open(path) == 0 && !image.is_open();
+    }
+    save_file(path, good.substr(0, good.size() - 1));
+    PopulationImage image;
+    fn_CHECK(image.open(path) == 0);
+    fn_CHECK(all_failed);
+    //A failed open closes the image that was open before.
+    save_file(path, good);
+    fn_CHECK(image.open(path) == 1);
+    save_file(path, good.substr(0, 100));
+    fn_CHECK(image.open(path) == 0 && !image.is_open() && image.size() == 0);
+    fn_CHECK(image.open(dna_test::temp_path("image_missing.bin")) == 0);
+    remove(path.c_str());
+}
+
+fn_TEST(image, bad_extents_are_rejected)
+{
+    std::string path = dna_test::temp_path("image_bad.bin");
+    std::vector<CharDna> genomes;
+    std::vector<Gene> genes;
+    std::string good = image_bytes(path, genomes, genes);
+    PopulationImageHeader h = header_of(good);
+    uint64_t slab = h.genes_offset - h.slab_offset;
+    uint64_t last = genomes.size() - 1;
+    PopulationImage image;
+
+    //Genome offset past the end of the slab.
+    std::string bytes = good;
+    poke<uint64_t>(bytes, h.offsets_offset + last * sizeof(uint64_t), slab + 64);
+    save_file(path, bytes);
+    fn_CHECK(image.open(path) == 0);
+
+    //Genome running past the end of the slab into the gene table.
+    bytes = good;
+    poke<uint32_t>(bytes, h.lengths_offset + last * sizeof(uint32_t), static_cast<uint32_t>(slab));
+    save_file(path, bytes);
+    fn_CHECK(image.open(path) == 0);
+
+    //Offset and length that wrap around when added.
+    bytes = good;
+    poke<uint64_t>(bytes, h.offsets_offset, ~0ull - 4);
+    poke<uint32_t>(bytes, h.lengths_offset, 8);
+    save_file(path, bytes);
+    fn_CHECK(image.open(path) == 0);
+
+    //A column that runs past the end of the file.
+    bytes = good;
+    PopulationImageHeader big = h;
+    big.genomes = h.genomes * 1000;
+    poke(bytes, 0, big);
+    save_file(path, bytes);
+    fn_CHECK(image.open(path) == 0);
+
+    //Written with another unit size.
+    bytes = good;
+    PopulationImageHeader unit = h;
+    unit.unit_size = fn_UNIT_SIZE * 2;
+    poke(bytes, 0, unit);
+    save_file(path, bytes);
+    fn_CHECK(image.open(path) == 0);
+
+    //The unmodified image still opens.
+    save_file(path, good);
+    fn_CHECK(image.open(path) == 1);
+    remove(path.c_str());
+}
@@ -0,0 +1,85 @@
+#include <thread>
+#include <vector>
+
+#include "../population.h"
+#include "test.h"
+
+fn_TEST(population, concurrent_reserve_and_insert)
+{
+    const unsigned int kThreads = 8;
+    const uint_fast64_t kBatches = 40;
+    const uint_fast64_t kBatch = 97;
+    ConcurrentPopulation pop;
+    std::vector<std::thread> threads;
+    for(unsigned int t = 0; t < kThreads; t++)
+    {
+        threads.emplace_back([&pop, t]() {
+            for(uint_fast64_t b = 0; b < kBatches; b++)
+            {
+                uint_fast64_t first = pop.reserve(kBatch);
+                for(uint_fast64_t i = 0; i < kBatch; i++)
+                {
+                    CharDna d(first + i, 8);
+                    d.set_char(0, static_cast<char>(t));
+                    pop.emplace_at(first + i, std::move(d));
+                }
+                //Single inserts interleaved with the ranges.
+                CharDna single(0, 8);
+                single.set_char(0, static_cast<char>(t));
+                pop.insert(std::move(single));
+            }
+        });
+    }
+    for(std::thread& t : threads)
+    {
+        t.join();
+    }
+    uint_fast64_t total = kThreads * kBatches * (kBatch + 1);
+    fn_CHECK(pop.size() == total);
+    std::vector<uint_fast64_t> per_thread(kThreads, 0);
+    bool all_ready = true;
+    bool seeds_match = true;
+    for(uint_fast64_t i = 0; i < total; i++)
+    {
+        if(!pop.ready(i))
+        {
+            all_ready = false;
+            continue;
+        }
+        //Range slots carry their own index as the seed.
+        if(pop[i].seed() != 0 && pop[i].seed() != i)
+        {
+            seeds_match = false;
+        }
+        unsigned int t = static_cast<unsigned char>(pop[i].char_data(0));
+        if(t < kThreads)
+        {
+            per_thread[t]++;
+        }
+    }
+    fn_CHECK(all_ready);
+    fn_CHECK(seeds_match);
+    for(unsigned int t = 0; t < kThreads; t++)
+    {
+        fn_CHECK(per_thread[t] == kBatches * (kBatch + 1));
+    }
+    fn_CHECK(!pop.ready(total));
+}
+
+fn_TEST(population, reserve_past_capacity_fails)
+{
+    ConcurrentPopulation pop;
+    fn_CHECK(pop.insert(CharDna(1, 4)) == 0);
+    uint_fast64_t limit = ConcurrentPopulation::kMaxChunks * ConcurrentPopulation::kChunkSize;
+    fn_CHECK(pop.reserve(limit) == ConcurrentPopulation::kNoIndex);
+    fn_CHECK(pop.size() == 1);
+    fn_CHECK(pop.reserve(3) == 1);
+    fn_CHECK(pop.size() == 4);
+    for(uint_fast64_t i = 1; i < 4; i++)
+    {
+        pop.emplace_at(i, CharDna(i, 4));
+    }
+    pop.clear();
+    fn_CHECK(pop.size() == 0);
+    fn_CHECK(!pop.ready(0));
+}
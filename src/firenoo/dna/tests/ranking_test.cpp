@@ -0,0 +1,128 @@
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "../ranking.h"
+#include "test.h"
+
+namespace
+{
+
+//Reference ranking: stable sort on the doubles, NaN last.
+std::vector<uint64_t> reference_rank(const std::vector<double>& fitness, bool higher_is_better)
+{
+    std::vector<uint64_t> order(fitness.size());
+    for(size_t i = 0; i < order.size(); i++)
+    {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint64_t x, uint64_t y) {
+        double a = fitness[x];
+        double b = fitness[y];
+        if(std::isnan(a) || std::isnan(b))
+        {
+            return !std::isnan(a) && std::isnan(b);
+        }
+        return higher_is_better ? a > b : a < b;
+    });
+    return order;
+}
+
+//Coarse values so ties are common, with a NaN and both infinities.
+std::vector<double> make_fitness(size_t n, uint_fast64_t seed)
+{
+    std::mt19937_64 rng(seed);
+    std::vector<double> out(n);
+    for(size_t i = 0; i < n; i++)
+    {
+        out[i] = static_cast<double>(static_cast<int>(rng() % 2001) - 1000) / 8.0;
+    }
+    out[n / 2] = NAN;
+    out[n / 3] = INFINITY;
+    out[n / 4] = -INFINITY;
+    return out;
+}
+
+} //namespace
+
+fn_TEST(ranking, fitness_key_preserves_order)
+{
+    std::vector<double> values = {-INFINITY, -1e300, -2.5, -1e-300, 0.0, 1e-300, 3.0, 1e300, INFINITY};
+    bool ordered = true;
+    for(size_t i = 1; i < values.size(); i++)
+    {
+        ordered = ordered && fitness_key(values[i - 1], false) < fitness_key(values[i], false);
+        ordered = ordered && fitness_key(values[i - 1], true) > fitness_key(values[i], true);
+    }
+    fn_CHECK(ordered);
+    fn_CHECK(fitness_key(NAN, false) > fitness_key(INFINITY, false));
+    fn_CHECK(fitness_key(NAN, true) > fitness_key(-INFINITY, true));
+}
+
+fn_TEST(ranking, rank_matches_stable_sort)
+{
+    //Large enough for the threaded radix passes.
+    std::vector<double> fitness = make_fitness(200003, 1);
+    for(bool higher : {false, true})
+    {
+        std::vector<uint64_t> want = reference_rank(fitness, higher);
+        fn_CHECK(rank_by_fitness(fitness, higher, 1) == want);
+        fn_CHECK(rank_by_fitness(fitness, higher, 4) == want);
+    }
+}
+
+fn_TEST(ranking, radix_sort_is_stable)
+{
+    std::mt19937_64 rng(2);
+    std::vector<RankEntry> entries(50000);
+    for(size_t i = 0; i < entries.size(); i++)
+    {
+        //Only the high byte varies, so most passes are skipped.
+        entries[i] = RankEntry{(rng() % 7) << 56, i};
+    }
+    std::vector<RankEntry> want = entries;
+    std::stable_sort(want.begin(), want.end(), [](const RankEntry& a, const RankEntry& b) {
+        return a.key < b.key;
+    });
+    radix_sort_pairs(entries, 3);
+    bool same = true;
+    for(size_t i = 0; i < entries.size(); i++)
+    {
+        same = same && entries[i].key == want[i].key && entries[i].index == want[i].index;
+    }
+    fn_CHECK(same);
+}
+
+fn_TEST(ranking, top_k_is_prefix_of_rank)
+{
+    std::vector<double> fitness = make_fitness(1000, 3);
+    std::vector<uint64_t> rank = reference_rank(fitness, true);
+    for(size_t k : {size_t(0), size_t(1), size_t(17), size_t(1000), size_t(5000)})
+    {
+        std::vector<uint64_t> top = top_k_by_fitness(fitness, k, true);
+        size_t n = std::min(k, fitness.size());
+        fn_CHECK(top.size() == n);
+        //Ties at the boundary may pick either index, so compare fitness.
+        bool same = top.size() == n;
+        for(size_t i = 0; i < n && same; i++)
+        {
+            same = fitness[top[i]] == fitness[rank[i]] || (std::isnan(fitness[top[i]]) && std::isnan(fitness[rank[i]]));
+        }
+        fn_CHECK(same);
+        std::vector<uint64_t> unsorted = top_k_by_fitness(fitness, k, true, false);
+        std::sort(unsorted.begin(), unsorted.end());
+        std::sort(top.begin(), top.end());
+        fn_CHECK(unsorted == top);
+    }
+}
+
+fn_TEST(ranking, reorder_moves_genomes)
+{
+    std::vector<std::vector<int>> pop = {{0}, {1, 1}, {2, 2, 2}};
+    std::vector<std::vector<int>> out = reorder_by_rank(pop, {2, 0});
+    fn_CHECK(out.size() == 2);
+    fn_CHECK(out[0].size() == 3 && out[1].size() == 1);
+    fn_CHECK(pop[2].empty() && pop[1].size() == 2);
+}
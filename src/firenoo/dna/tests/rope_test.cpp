@@ -0,0 +1,80 @@
+#include <stdint.h>
+#include <algorithm>
+#include <random>
+#include <string>
+
+#include "../genome_init.h"
+#include "../rope_dna.h"
+#include "test.h"
+
+//The rope is checked against a plain byte string that receives the same
+//edits, and must flatten to the same CharDna.
+
+namespace
+{
+
+CharDna random_genome(uint_fast64_t seed, uint_fast32_t len)
+{
+    CharDna g(seed, 0);
+    random_fill(g, len);
+    return g;
+}
+
+bool equals(const CharDna& g, const std::string& bytes)
+{
+    return g.len() == bytes.size() && std::string(g.all_data(), g.len()) == bytes;
+}
+
+} //namespace
+
+fn_TEST(rope, edits_match_dense)
+{
+    std::mt19937_64 rng(11);
+    CharDna start = random_genome(8, 500);
+    RopeDna rope(start);
+    std::string model(start.all_data(), start.len());
+    bool same = true;
+    for(unsigned int op = 0; op < 2000; op++)
+    {
+        unsigned int kind = static_cast<unsigned int>(rng() % 4);
+        uint_fast32_t at = static_cast<uint_fast32_t>(rng() % (model.size() + 1));
+        if(kind == 0)
+        {
+            std::string bytes(1 + rng() % 90, static_cast<char>(rng()));
+            rope.insert(at, bytes.data(), static_cast<uint_fast32_t>(bytes.size()));
+            model.insert(at, bytes);
+        } else if(kind == 1)
+        {
+            uint_fast32_t n = static_cast<uint_fast32_t>(rng() % 70);
+            rope.erase(at, n);
+            model.erase(std::min<size_t>(at, model.size()), n);
+        } else if(kind == 2 && at < model.size())
+        {
+            char c = static_cast<char>(rng());
+            rope.set_char(at, c);
+            model[at] = c;
+        } else
+        {
+            char c = static_cast<char>(rng());
+            rope.append_char(c);
+            model.push_back(c);
+        }
+        if(op % 500 == 499)
+        {
+            rope.compact();
+        }
+        same = same && rope.len() == model.size();
+        if(!model.empty())
+        {
+            uint_fast32_t probe = static_cast<uint_fast32_t>(rng() % model.size());
+            same = same && rope.char_data(probe) == model[probe];
+        }
+    }
+    fn_CHECK(same);
+    CharDna flat = rope.flatten();
+    fn_CHECK(equals(flat, model));
+    fn_CHECK(flat.seed() == 8);
+    //Insert past the end does nothing.
+    rope.insert(rope.len() + 1, "z", 1);
+    fn_CHECK(rope.len() == model.size());
+}
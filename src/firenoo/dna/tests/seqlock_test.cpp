@@ -0,0 +1,78 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "../seqlock_dna.h"
+#include "test.h"
+
+//Every write group leaves all bytes equal, growing the genome now and then,
+//so a torn snapshot shows up as a byte that differs from the first.
+fn_TEST(seqlock, readers_see_whole_writes)
+{
+    const unsigned int kReaders = 4;
+    const unsigned int kWrites = 20000;
+    SeqlockDna dna(7, 16);
+    dna.begin_write();
+    for(uint_fast32_t i = 0; i < 16; i++)
+    {
+        dna.set_char(i, 0);
+    }
+    dna.end_write();
+    std::atomic<bool> done(false);
+    std::atomic<unsigned int> torn(0);
+    std::atomic<uint_fast64_t> snapshots(0);
+    std::vector<std::thread> readers;
+    for(unsigned int r = 0; r < kReaders; r++)
+    {
+        readers.emplace_back([&]() {
+            while(!done.load(std::memory_order_acquire))
+            {
+                CharDna s = dna.snapshot();
+                for(uint_fast32_t i = 1; i < s.len(); i++)
+                {
+                    if(s.char_data(i) != s.char_data(0))
+                    {
+                        torn++;
+                        break;
+                    }
+                }
+                if(s.seed() != 7 || s.len() < 16)
+                {
+                    torn++;
+                }
+                snapshots++;
+            }
+        });
+    }
+    //Start writing only once the readers are taking snapshots.
+    while(snapshots.load() < kReaders)
+    {
+        std::this_thread::yield();
+    }
+    uint_fast64_t before = dna.version();
+    for(unsigned int w = 1; w <= kWrites; w++)
+    {
+        char v = static_cast<char>(w);
+        dna.begin_write();
+        for(uint_fast32_t i = 0; i < dna.len(); i++)
+        {
+            dna.set_char(i, v);
+        }
+        if(w % 1000 == 0)
+        {
+            //Grows the buffer while readers may be copying the old one.
+            dna.append_char(v);
+        }
+        dna.end_write();
+    }
+    done.store(true, std::memory_order_release);
+    for(std::thread& t : readers)
+    {
+        t.join();
+    }
+    fn_CHECK(torn.load() == 0);
+    fn_CHECK(dna.version() == before + kWrites);
+    fn_CHECK(dna.len() == 16 + kWrites / 1000);
+    fn_CHECK(dna.char_data(0) == static_cast<char>(kWrites));
+    fn_CHECK(dna.char_data(dna.len()) == 0);
+}
@@ -0,0 +1,222 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "../serialize.h"
+#include "test.h"
+
+namespace
+{
+
+struct Read
+{
+    uint_fast64_t seed;
+    uint_fast32_t unit_size;
+    uint_fast32_t type_id;
+    uint_fast32_t schema_id;
+    uint_fast64_t lineage;
+    uint_fast32_t ref;
+    std::string bytes;
+};
+
+int read_all(const std::string& path, std::vector<Read>& out)
+{
+    return read_dna_records(path, [&out](const DnaRecord& r) {
+        out.push_back(Read{r.seed, r.unit_size, r.type_id, r.schema_id, r.lineage, r.ref,
+            std::string(r.data, r.len)});
+    });
+}
+
+std::string load_file(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void save_file(const std::string& path, const std::string& bytes)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+void put_le(std::string& out, uint_fast64_t v, unsigned int bytes)
+{
+    for(unsigned int i = 0; i < bytes; i++)
+    {
+        out.push_back(static_cast<char>(v >> (8 * i)));
+    }
+}
+
+//Original format header: len, unit size, seed, then int32 fields up to '\n'.
+void put_legacy_header(std::string& out, uint_fast32_t len, uint_fast64_t seed, const std::vector<uint_fast32_t>& fields)
+{
+    put_le(out, len, 4);
+    put_le(out, fn_UNIT_SIZE, 4);
+    put_le(out, seed, 8);
+    for(uint_fast32_t f : fields)
+    {
+        put_le(out, f, 4);
+    }
+    put_le(out, '\n', 4);
+}
+
+} //namespace
+
+fn_TEST(serialize, tlv_round_trip_with_refs)
+{
+    std::string path = dna_test::temp_path("tlv.bin");
+    std::string a(100, 'a');
+    std::string b = "bytes of b";
+    std::vector<DnaRecord> records;
+    records.push_back(DnaRecord{1, fn_UNIT_SIZE, static_cast<uint_fast32_t>(a.size()), a.data()});
+    records.push_back(DnaRecord{2, fn_UNIT_SIZE, static_cast<uint_fast32_t>(b.size()), b.data()});
+    records.push_back(DnaRecord{3, fn_UNIT_SIZE, static_cast<uint_fast32_t>(a.size()), a.data(), 0});
+    //Reference to a reference; written as a reference to record 0.
+    records.push_back(DnaRecord{4, fn_UNIT_SIZE, static_cast<uint_fast32_t>(a.size()), a.data(), 2});
+    records.push_back(DnaRecord{5, fn_UNIT_SIZE, 0, nullptr});
+    records[1].schema_id = 9;
+    records[1].lineage = 42;
+    fn_CHECK(write_dna_records(path, records) == 1);
+    std::vector<Read> got;
+    fn_CHECK(read_all(path, got) == 1);
+    fn_CHECK(got.size() == records.size());
+    if(got.size() == records.size())
+    {
+        fn_CHECK(got[0].seed == 1 && got[0].bytes == a && got[0].ref == DnaRecord::kNoRef);
+        fn_CHECK(got[1].bytes == b && got[1].schema_id == 9 && got[1].lineage == 42);
+        fn_CHECK(got[0].schema_id == 0 && got[0].lineage == DnaRecord::kNoLineage);
+        fn_CHECK(got[2].seed == 3 && got[2].bytes == a && got[2].ref == 0);
+        fn_CHECK(got[3].seed == 4 && got[3].bytes == a && got[3].ref == 0);
+        fn_CHECK(got[4].bytes.empty() && got[4].type_id == fn_TYPEDDNA_ID);
+    }
+    //The shared payload is stored once; writing every copy costs more.
+    std::string copies_path = dna_test::temp_path("tlv_copies.bin");
+    records[2].ref = DnaRecord::kNoRef;
+    records[3].ref = DnaRecord::kNoRef;
+    fn_CHECK(write_dna_records(copies_path, records) == 1);
+    fn_CHECK(load_file(path).size() + a.size() < load_file(copies_path).size());
+    remove(path.c_str());
+    remove(copies_path.c_str());
+}
+
+fn_TEST(serialize, forward_ref_is_not_written)
+{
+    std::string path = dna_test::temp_path("forward.bin");
+    remove(path.c_str());
+    std::string a = "abc";
+    std::vector<DnaRecord> records;
+    records.push_back(DnaRecord{1, fn_UNIT_SIZE, 3, a.data(), 1});
+    records.push_back(DnaRecord{2, fn_UNIT_SIZE, 3, a.data()});
+    fn_CHECK(write_dna_records(path, records) == 0);
+    fn_CHECK(!std::ifstream(path).is_open());
+}
+
+fn_TEST(serialize, deserialize_char_dna)
+{
+    std::string path = dna_test::temp_path("chardna.bin");
+    CharDna x(11, 5, "hello");
+    CharDna y(12, 3, "abc");
+    serialize(path, {&x, &y});
+    std::vector<CharDna> back;
+    fn_CHECK(deserialize(path, back) == 1);
+    fn_CHECK(back.size() == 2);
+    if(back.size() == 2)
+    {
+        fn_CHECK(back[0].seed() == 11 && std::string(back[0].all_data(), back[0].len()) == "hello");
+        fn_CHECK(back[1].seed() == 12 && std::string(back[1].all_data(), back[1].len()) == "abc");
+    }
+    remove(path.c_str());
+}
+
+fn_TEST(serialize, legacy_records)
+{
+    std::string path = dna_test::temp_path("legacy.bin");
+    std::string bytes;
+    put_le(bytes, 2, 4);
+    put_legacy_header(bytes, 4, 7, {fn_TYPEDDNA_ID, 123});
+    bytes += "wxyz";
+    put_legacy_header(bytes, 2, 8, {fn_TYPEDDNA_ID});
+    bytes += "pq";
+    save_file(path, bytes);
+    std::vector<Read> got;
+    fn_CHECK(read_all(path, got) == 1);
+    fn_CHECK(got.size() == 2);
+    if(got.size() == 2)
+    {
+        fn_CHECK(got[0].seed == 7 && got[0].bytes == "wxyz" && got[0].unit_size == fn_UNIT_SIZE);
+        fn_CHECK(got[1].seed == 8 && got[1].bytes == "pq" && got[1].ref == DnaRecord::kNoRef);
+    }
+    remove(path.c_str());
+}
+
+fn_TEST(serialize, corrupt_input_is_rejected)
+{
+    std::string path = dna_test::temp_path("corrupt.bin");
+    std::string payload(64, 'p');
+    std::vector<DnaRecord> records;
+    records.push_back(DnaRecord{1, fn_UNIT_SIZE, 64, payload.data()});
+    records.push_back(DnaRecord{2, fn_UNIT_SIZE, 64, payload.data()});
+    fn_CHECK(write_dna_records(path, records) == 1);
+    std::string good = load_file(path);
+    std::vector<Read> got;
+
+    //Truncated anywhere after the magic.
+    bool all_failed = true;
+    for(size_t cut = 4; cut < good.size(); cut += 5)
+    {
+        save_file(path, good.substr(0, cut));
+        all_failed = all_failed && read_all(path, got) == 0;
+    }
+    fn_CHECK(all_failed);
+
+    //A flipped payload byte fails the checksum.
+    std::string flipped = good;
+    flipped[flipped.size() - 1] ^= 1;
+    save_file(path, flipped);
+    fn_CHECK(read_all(path, got) == 0);
+
+    //A newer format version.
+    std::string newer = good;
+    newer[4] = 3;
+    save_file(path, newer);
+    fn_CHECK(read_all(path, got) == 0);
+
+    //A legacy length far past the end of the file.
+    std::string huge;
+    put_le(huge, 1, 4);
+    put_legacy_header(huge, 0xfffffff0u, 1, {fn_TYPEDDNA_ID});
+    huge += "abcd";
+    save_file(path, huge);
+    fn_CHECK(read_all(path, got) == 0);
+
+    //A reference that also claims payload bytes of its own.
+    std::string refs_path = dna_test::temp_path("corrupt_refs.bin");
+    records.resize(1);
+    fn_CHECK(write_dna_records(path, records) == 1);
+    size_t ref_at = load_file(path).size();
+    records.push_back(DnaRecord{3, fn_UNIT_SIZE, 64, payload.data(), 0});
+    fn_CHECK(write_dna_records(refs_path, records) == 1);
+    std::string padded = load_file(refs_path);
+    padded[ref_at + 4] = 4;
+    padded += "wxyz";
+    save_file(path, padded);
+    fn_CHECK(read_all(path, got) == 0);
+    remove(refs_path.c_str());
+
+    //A zero unit size.
+    std::string unit;
+    put_le(unit, 1, 4);
+    put_le(unit, 1, 4);
+    put_le(unit, 0, 4);
+    put_le(unit, 1, 8);
+    put_le(unit, '\n', 4);
+    unit += "x";
+    save_file(path, unit);
+    fn_CHECK(read_all(path, got) == 0);
+
+    fn_CHECK(read_all(dna_test::temp_path("missing.bin"), got) == 0);
+    remove(path.c_str());
+}
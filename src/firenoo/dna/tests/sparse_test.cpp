@@ -0,0 +1,77 @@
+#include <stdint.h>
+#include <random>
+#include <string>
+
+#include "../sparse_dna.h"
+#include "test.h"
+
+//SparseDna is checked against a plain byte string that receives the same
+//edits, and must convert to the same CharDna.
+
+namespace
+{
+
+bool equals(const CharDna& g, const std::string& bytes)
+{
+    return g.len() == bytes.size() && std::string(g.all_data(), g.len()) == bytes;
+}
+
+char model_byte(const std::string& bytes, uint_fast32_t i)
+{
+    return i < bytes.size() ? bytes[i] : 0;
+}
+
+} //namespace
+
+fn_TEST(sparse, round_trips_dense)
+{
+    CharDna dense(9, 200);
+    dense.resize(200);
+    dense.set_char(3, 'a');
+    dense.set_char(100, 'b');
+    dense.set_char(199, 'c');
+    SparseDna sparse = SparseDna::from_dense(dense);
+    fn_CHECK(sparse.len() == 200);
+    fn_CHECK(sparse.seed() == 9);
+    fn_CHECK(sparse.units() == 3);
+    fn_CHECK(equals(sparse.to_dense(), std::string(dense.all_data(), dense.len())));
+}
+
+fn_TEST(sparse, edits_match_dense)
+{
+    std::mt19937_64 rng(21);
+    SparseDna sparse(12, 64);
+    std::string model(64, 0);
+    bool same = true;
+    for(unsigned int op = 0; op < 3000; op++)
+    {
+        //Mostly zeros, so units are dropped as well as added.
+        char c = rng() % 3 == 0 ? static_cast<char>(rng()) : 0;
+        if(op % 50 == 0)
+        {
+            sparse.append_char(c);
+            model.push_back(c);
+        } else
+        {
+            uint_fast32_t at = static_cast<uint_fast32_t>(rng() % (model.size() + 20));
+            sparse.set_char(at, c);
+            if(at >= model.size())
+            {
+                model.resize(at + 1, 0);
+            }
+            model[at] = c;
+        }
+        uint_fast32_t probe = static_cast<uint_fast32_t>(rng() % (model.size() + 5));
+        same = same && sparse.len() == model.size() && sparse.char_data(probe) == model_byte(model, probe);
+    }
+    fn_CHECK(same);
+    fn_CHECK(equals(sparse.to_dense(), model));
+    //Stored units are exactly the non-zero ones.
+    size_t nonzero = 0;
+    for(size_t u = 0; u * SparseDna::unit_size < model.size(); u++)
+    {
+        std::string unit = model.substr(u * SparseDna::unit_size, SparseDna::unit_size);
+        nonzero += unit.find_first_not_of('\0') != std::string::npos ? 1 : 0;
+    }
+    fn_CHECK(sparse.units() == nonzero);
+}
@@ -0,0 +1,47 @@
+#ifndef fn_TEST_H
+#define fn_TEST_H
+
+#include <string>
+
+//Minimal test harness for dna_tests. A test is a function registered under
+//a suite name with fn_TEST; fn_CHECK records a failure and carries on, so
+//one run reports every broken expectation of a test.
+//
+//  dna_tests [SUITE]
+//
+//runs every test, or only the tests of SUITE. The exit status is 1 if any
+//check failed.
+
+namespace dna_test
+{
+
+struct Register
+{
+    Register(const char* suite, const char* name, void (*fn)());
+};
+
+void fail(const char* file, int line, const char* expr);
+
+/**
+ * Path of a scratch file in the system temp directory, unique to this
+ * process. The caller removes it.
+ */
+std::string temp_path(const std::string& name);
+
+} //namespace dna_test
+
+#define fn_CHECK(expr) \
+    do \
+    { \
+        if(!(expr)) \
+        { \
+            dna_test::fail(__FILE__, __LINE__, #expr); \
+        } \
+    } while(0)
+
+#define fn_TEST(suite, name) \
+    static void suite##_##name(); \
+    static dna_test::Register suite##_##name##_reg(#suite, #name, suite##_##name); \
+    static void suite##_##name()
+
+#endif
@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include <string.h>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "test.h"
+
+namespace
+{
+
+struct Test
+{
+    const char* suite;
+    const char* name;
+    void (*fn)();
+};
+
+std::vector<Test>& registry()
+{
+    static std::vector<Test> tests;
+    return tests;
+}
+
+unsigned int g_failures = 0;
+
+} //namespace
+
+namespace dna_test
+{
+
+Register::Register(const char* suite, const char* name, void (*fn)())
+{
+    registry().push_back(Test{suite, name, fn});
+}
+
+void fail(const char* file, int line, const char* expr)
+{
+    fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+    g_failures++;
+}
+
+std::string temp_path(const std::string& name)
+{
+    std::string file = "typeddna_" + std::to_string(getpid()) + "_" + name;
+    return (std::filesystem::temp_directory_path() / file).string();
+}
+
+} //namespace dna_test
+
+int main(int argc, char** argv)
+{
+    const char* suite = argc > 1 ? argv[1] : nullptr;
+    unsigned int run = 0;
+    for(const Test& t : registry())
+    {
+        if(suite != nullptr && strcmp(suite, t.suite) != 0)
+        {
+            continue;
+        }
+        unsigned int before = g_failures;
+        t.fn();
+        printf("%s %s.%s\n", g_failures == before ? "ok  " : "FAIL", t.suite, t.name);
+        run++;
+    }
+    if(run == 0)
+    {
+        fprintf(stderr, "no tests in suite %s\n", suite != nullptr ? suite : "(all)");
+        return 1;
+    }
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+#include <stdint.h>
+#include <vector>
+
+#include "../genome_init.h"
+#include "../transpose.h"
+#include "test.h"
+
+namespace
+{
+
+//count random genomes of len bytes; every third one is shorter, so reads
+//past a genome's length are exercised.
+std::vector<CharDna> make_genomes(size_t count, uint_fast32_t len)
+{
+    std::vector<CharDna> out;
+    for(size_t i = 0; i < count; i++)
+    {
+        out.emplace_back(i, 0);
+        random_fill(out.back(), i % 3 == 0 ? len / 2 + static_cast<uint_fast32_t>(i % 5) : len);
+    }
+    return out;
+}
+
+std::vector<const CharDna*> views(const std::vector<CharDna>& genomes)
+{
+    std::vector<const CharDna*> out;
+    for(const CharDna& g : genomes)
+    {
+        out.push_back(&g);
+    }
+    return out;
+}
+
+unsigned char byte_at(const CharDna& g, uint_fast32_t i)
+{
+    return i < g.len() ? static_cast<unsigned char>(g.char_data(i)) : 0;
+}
+
+} //namespace
+
+//Counts chosen so neither axis is a multiple of the 16x16 tile.
+fn_TEST(transpose, chars_match_genomes)
+{
+    const uint_fast32_t kLoci = 53;
+    std::vector<CharDna> genomes = make_genomes(37, kLoci);
+    LocusColumns<char> cols = transpose_chars(views(genomes), kLoci);
+    fn_CHECK(cols.loci() == kLoci);
+    fn_CHECK(cols.individuals() == genomes.size());
+    bool same = true;
+    for(uint_fast32_t l = 0; l < kLoci; l++)
+    {
+        for(size_t i = 0; i < genomes.size(); i++)
+        {
+            same = same && static_cast<unsigned char>(cols.at(l, i)) == byte_at(genomes[i], l);
+        }
+    }
+    fn_CHECK(same);
+}
+
+fn_TEST(transpose, int32_decodes_little_endian)
+{
+    const uint_fast32_t kLoci = 11;
+    std::vector<CharDna> genomes = make_genomes(23, kLoci * 4);
+    LocusColumns<uint32_t> cols = transpose_int32(views(genomes), kLoci);
+    bool same = true;
+    for(uint_fast32_t l = 0; l < kLoci; l++)
+    {
+        for(size_t i = 0; i < genomes.size(); i++)
+        {
+            uint32_t v = 0;
+            for(unsigned int b = 0; b < 4; b++)
+            {
+                v |= static_cast<uint32_t>(byte_at(genomes[i], l * 4 + b)) << (8 * b);
+            }
+            same = same && cols.at(l, i) == v;
+        }
+    }
+    fn_CHECK(same);
+}
@@ -0,0 +1,171 @@
+#include <string.h>
+
+#include "phase_timing.h"
+#include "transpose.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define fn_TRANSPOSE_SSE2 1
+#endif
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define fn_TRANSPOSE_LE 1
+#endif
+
+namespace
+{
+
+const size_t kTile = 16;
+
+//Byte at offset, or 0 past the genome's length.
+char byte_at(const CharDna* d, uint_fast32_t offset)
+{
+    return offset < d->len() ? d->char_data(offset) : 0;
+}
+
+uint32_t int32_at(const CharDna* d, uint_fast32_t unit)
+{
+    uint32_t v = 0;
+    for(unsigned int i = 0; i < 4; i++)
+    {
+        v |= static_cast<uint32_t>(byte_at(d, unit * 4 + i) & 0xff) << (8 * i);
+    }
+    return v;
+}
+
+//Whether all genomes in [g, g + count) hold bytes [offset, offset + bytes).
+bool tile_in_bounds(const std::vector<const CharDna*>& genomes, size_t g, size_t count,
+    uint_fast32_t offset, uint_fast32_t bytes)
+{
+    for(size_t i = g; i < g + count; i++)
+    {
+        if(genomes[i]->len() < offset + bytes)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifdef fn_TRANSPOSE_SSE2
+//Transposes a 16x16 byte tile: rows[i] byte j ends up in cols[j] byte i.
+void transpose16x16(const __m128i rows[16], __m128i cols[16])
+{
+    __m128i s1[8][2];
+    for(unsigned int p = 0; p < 8; p++)
+    {
+        s1[p][0] = _mm_unpacklo_epi8(rows[2 * p], rows[2 * p + 1]);
+        s1[p][1] = _mm_unpackhi_epi8(rows[2 * p], rows[2 * p + 1]);
+    }
+    __m128i s2[4][4];
+    for(unsigned int q = 0; q < 4; q++)
+    {
+        for(unsigned int h = 0; h < 2; h++)
+        {
+            s2[q][h * 2] = _mm_unpacklo_epi16(s1[2 * q][h], s1[2 * q + 1][h]);
+            s2[q][h * 2 + 1] = _mm_unpackhi_epi16(s1[2 * q][h], s1[2 * q + 1][h]);
+        }
+    }
+    __m128i s3[2][8];
+    for(unsigned int s = 0; s < 2; s++)
+    {
+        for(unsigned int k = 0; k < 4; k++)
+        {
+            s3[s][k * 2] = _mm_unpacklo_epi32(s2[2 * s][k], s2[2 * s + 1][k]);
+            s3[s][k * 2 + 1] = _mm_unpackhi_epi32(s2[2 * s][k], s2[2 * s + 1][k]);
+        }
+    }
+    for(unsigned int m = 0; m < 8; m++)
+    {
+        cols[2 * m] = _mm_unpacklo_epi64(s3[0][m], s3[1][m]);
+        cols[2 * m + 1] = _mm_unpackhi_epi64(s3[0][m], s3[1][m]);
+    }
+}
+#endif
+
+} //namespace
+
+LocusColumns<char> transpose_chars(const std::vector<const CharDna*>& genomes, uint_fast32_t loci)
+{
+    fn_PHASE_SCOPE(PHASE_DECODE);
+    size_t n = genomes.size();
+    LocusColumns<char> out(loci, n);
+    for(size_t g = 0; g < n; g += kTile)
+    {
+        size_t rows = n - g < kTile ? n - g : kTile;
+        for(uint_fast32_t l = 0; l < loci; l += kTile)
+        {
+            uint_fast32_t cols = loci - l < kTile ? loci - l : kTile;
+#ifdef fn_TRANSPOSE_SSE2
+            if(rows == kTile && cols == kTile && tile_in_bounds(genomes, g, kTile, l, kTile))
+            {
+                __m128i in[16];
+                __m128i tr[16];
+                for(unsigned int r = 0; r < 16; r++)
+                {
+                    in[r] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(genomes[g + r]->all_data() + l));
+                }
+                transpose16x16(in, tr);
+                for(unsigned int c = 0; c < 16; c++)
+                {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out.column(l + c) + g), tr[c]);
+                }
+                continue;
+            }
+#endif
+            //Edge tiles and the portable path.
+            for(size_t r = 0; r < rows; r++)
+            {
+                const CharDna* d = genomes[g + r];
+                for(uint_fast32_t c = 0; c < cols; c++)
+                {
+                    out.column(l + c)[g + r] = byte_at(d, l + c);
+                }
+            }
+        }
+    }
+    return out;
+}
+
+LocusColumns<uint32_t> transpose_int32(const std::vector<const CharDna*>& genomes, uint_fast32_t loci)
+{
+    fn_PHASE_SCOPE(PHASE_DECODE);
+    size_t n = genomes.size();
+    LocusColumns<uint32_t> out(loci, n);
+    const size_t kQuad = 4;
+    for(size_t g = 0; g < n; g += kQuad)
+    {
+        size_t rows = n - g < kQuad ? n - g : kQuad;
+        for(uint_fast32_t l = 0; l < loci; l += kQuad)
+        {
+            uint_fast32_t cols = loci - l < kQuad ? loci - l : kQuad;
+#if defined(fn_TRANSPOSE_SSE2) && defined(fn_TRANSPOSE_LE)
+            if(rows == kQuad && cols == kQuad && tile_in_bounds(genomes, g, kQuad, l * 4, 16))
+            {
+                __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(genomes[g]->all_data() + l * 4));
+                __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(genomes[g + 1]->all_data() + l * 4));
+                __m128i r2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(genomes[g + 2]->all_data() + l * 4));
+                __m128i r3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(genomes[g + 3]->all_data() + l * 4));
+                __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+                __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+                __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+                __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out.column(l) + g), _mm_unpacklo_epi64(t0, t1));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out.column(l + 1) + g), _mm_unpackhi_epi64(t0, t1));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out.column(l + 2) + g), _mm_unpacklo_epi64(t2, t3));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out.column(l + 3) + g), _mm_unpackhi_epi64(t2, t3));
+                continue;
+            }
+#endif
+            for(size_t r = 0; r < rows; r++)
+            {
+                const CharDna* d = genomes[g + r];
+                for(uint_fast32_t c = 0; c < cols; c++)
+                {
+                    out.column(l + c)[g + r] = int32_at(d, l + c);
+                }
+            }
+        }
+    }
+    return out;
+}
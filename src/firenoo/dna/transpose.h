@@ -0,0 +1,69 @@
+#ifndef fn_TRANSPOSE_H
+#define fn_TRANSPOSE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#include "char_dna.h"
+
+/**
+ * Locus-major copy of a population: column k holds locus k of every
+ * individual contiguously, so per-locus scans are unit-stride.
+ */
+template<typename T>
+class LocusColumns
+{
+private:
+    std::vector<T> m_data;
+    uint_fast32_t m_loci;
+    size_t m_individuals;
+
+public:
+    LocusColumns(uint_fast32_t loci, size_t individuals) :
+        m_data(static_cast<size_t>(loci) * individuals),
+        m_loci(loci),
+        m_individuals(individuals)
+    {
+    }
+
+    const T* column(uint_fast32_t locus) const
+    {
+        return m_data.data() + static_cast<size_t>(locus) * m_individuals;
+    }
+
+    T* column(uint_fast32_t locus)
+    {
+        return m_data.data() + static_cast<size_t>(locus) * m_individuals;
+    }
+
+    T at(uint_fast32_t locus, size_t individual) const
+    {
+        return column(locus)[individual];
+    }
+
+    uint_fast32_t loci() const
+    {
+        return m_loci;
+    }
+
+    size_t individuals() const
+    {
+        return m_individuals;
+    }
+};
+
+/**
+ * Transposes the first loci bytes of every genome into columns. Bytes past a
+ * genome's length read as 0. Works in 16x16 tiles, using SSE2 shuffles where
+ * available.
+ */
+LocusColumns<char> transpose_chars(const std::vector<const CharDna*>& genomes, uint_fast32_t loci);
+
+/**
+ * Same for 32-bit loci, decoded little endian as Int32Dna does. loci is
+ * measured in 32-bit units. Works in 4x4 tiles of 32-bit values.
+ */
+LocusColumns<uint32_t> transpose_int32(const std::vector<const CharDna*>& genomes, uint_fast32_t loci);
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef fn_TYPED_DNA_H
+#define fn_TYPED_DNA_H
+
+#include <memory>
+
+#include "char_dna.h"
+
+/**
+ * Wraps a CharDna instance, which enables processing of data in 32-bit units.
+ */
+template<uint_fast32_t UnitSize>
+class BasicInt32Dna
+{
+private:
+    const std::shared_ptr<BasicCharDna<UnitSize>> m32_inst;
+    /**
+     * Generates the offset, in 4 byte units, to use in appending to the end of
+     * the wrapped CharDna instance.
+     */
+    uint_fast32_t align()
+    {
+        uint_fast32_t offset = m32_inst->len();
+        offset = offset / 4 + ((offset % 4 + 3) / 4);
+        return offset;
+    }
+
+public:
+    explicit BasicInt32Dna(std::shared_ptr<BasicCharDna<UnitSize>> ptr) :
+        m32_inst(ptr)
+    {
+    }
+
+    /**
+     * Sets 4 bytes of data at the specified offset. The offset is measured in
+     * 32-bit units. Aligns to the next 32-bit block.
+     */
+    void set_int(uint_fast32_t offset, uint_fast32_t newData)
+    {
+        offset *= 4;
+        for(int i = 0; i < 4; i++) {
+            m32_inst->set_char(offset + i, static_cast<char>(newData));
+            newData >>= 8;
+        }
+    }
+
+    /**
+     * Adds 4 bytes of data to the end of the data array. The data is aligned
+     * to the next 32-bit boundary.
+     */
+    void append_int(uint_fast32_t newData)
+    {
+        set_int(align(), newData);
+    }
+
+    /**
+     * Gets 4 sequential bytes of data at the specified offset. The offset is
+     * measured in 32-bit units. The data is stored in little endian format in
+     * a 32-bit integer.
+     */
+    uint_fast32_t int_data(uint_fast32_t offset) const
+    {
+        uint_fast32_t data = 0;
+        offset *= 4;
+        for(int i = 0; i < 4; i++) {
+            data |= static_cast<uint_fast32_t>(m32_inst->char_data(offset + i) & 0xff) << (8 * i);
+        }
+        return data;
+    }
+};
+
+/**
+ * Wraps a CharDna instance, which enables processing of data in 64-bit units.
+ */
+template<uint_fast32_t UnitSize>
+class BasicLong64Dna
+{
+private:
+    const std::shared_ptr<BasicCharDna<UnitSize>> m64_inst;
+    /**
+     * Generates the offset, in 64-bit units, to use in appending to the end of
+     * the wrapped CharDna instance.
+     */
+    uint_fast32_t align()
+    {
+        uint_fast32_t offset = m64_inst->len();
+        offset = offset / 8 + (offset % 8 + 7) / 8;
+        return offset;
+    }
+
+public:
+    explicit BasicLong64Dna(std::shared_ptr<BasicCharDna<UnitSize>> instance) :
+        m64_inst(instance)
+    {
+    }
+    
+
+    /**
+     * Sets 4 bytes of data at the specified offset. The offset is measured in
+     * 64-bit units. Aligns to the next 64-bit block.
+     */
+    void set_long(uint_fast32_t offset, uint_fast64_t newData)
+    {
+        offset *= 8;
+        for(int i = 0; i < 8; i++) {
+            m64_inst->set_char(offset + i, static_cast<char>(newData));
+            newData >>= 8;
+        }
+    }
+
+    /**
+     * Adds 4 bytes of data to the end of the data array. The data is aligned
+     * to the next 64-bit boundary.
+     */
+    void append_long(uint_fast64_t newData)
+    {
+        set_long(align(), newData);
+    }
+
+    /**
+     * Gets 4 sequential bytes of data at the specified offset. The offset is
+     * measured in 64-bit units. The data is stored in little endian format in
+     * a 64-bit integer.
+     */
+    uint_fast64_t long_data(uint_fast32_t offset) const
+    {
+        uint_fast64_t data = 0;
+        offset *= 8;
+        for(int i = 0; i < 8; i++) {
+            data |= static_cast<uint_fast64_t>(m64_inst->char_data(offset + i) & 0xff) << (8 * i);
+        }
+        return data;
+    }
+};
+
+typedef BasicInt32Dna<fn_UNIT_SIZE> Int32Dna;
+typedef BasicLong64Dna<fn_UNIT_SIZE> Long64Dna;
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef fn_UINT128_H
+#define fn_UINT128_H
+
+#include <stdint.h>
+
+/**
+ * Unsigned 128-bit integer, arithmetic modulo 2^128. Uses the compiler's
+ * 128-bit type where there is one and 64-bit halves elsewhere, so exact
+ * wide sums do not depend on unsigned __int128.
+ */
+struct Uint128
+{
+    uint64_t lo;
+    uint64_t hi;
+
+    Uint128(uint64_t v = 0) :
+        lo(v),
+        hi(0)
+    {
+    }
+
+    Uint128(uint64_t high, uint64_t low) :
+        lo(low),
+        hi(high)
+    {
+    }
+
+    //Full product of two 64-bit values.
+    static Uint128 mul(uint64_t a, uint64_t b)
+    {
+#if defined(__SIZEOF_INT128__)
+        unsigned __int128 p = static_cast<unsigned __int128>(a) * b;
+        return Uint128(static_cast<uint64_t>(p >> 64), static_cast<uint64_t>(p));
+#else
+        uint64_t a0 = a & 0xffffffffull;
+        uint64_t a1 = a >> 32;
+        uint64_t b0 = b & 0xffffffffull;
+        uint64_t b1 = b >> 32;
+        uint64_t p00 = a0 * b0;
+        uint64_t p01 = a0 * b1;
+        uint64_t p10 = a1 * b0;
+        uint64_t mid = (p00 >> 32) + (p01 & 0xffffffffull) + (p10 & 0xffffffffull);
+        return Uint128(a1 * b1 + (p01 >> 32) + (p10 >> 32) + (mid >> 32), (mid << 32) | (p00 & 0xffffffffull));
+#endif
+    }
+
+    Uint128& operator+=(const Uint128& other)
+    {
+        uint64_t low = lo + other.lo;
+        hi += other.hi + (low < lo ? 1 : 0);
+        lo = low;
+        return *this;
+    }
+
+    Uint128& operator-=(const Uint128& other)
+    {
+        hi -= other.hi + (lo < other.lo ? 1 : 0);
+        lo -= other.lo;
+        return *this;
+    }
+
+    Uint128 operator+(const Uint128& other) const
+    {
+        Uint128 r = *this;
+        return r += other;
+    }
+
+    Uint128 operator-(const Uint128& other) const
+    {
+        Uint128 r = *this;
+        return r -= other;
+    }
+
+    Uint128 operator*(uint64_t b) const
+    {
+        Uint128 r = mul(lo, b);
+        r.hi += hi * b;
+        return r;
+    }
+
+    long double to_long_double() const
+    {
+        return static_cast<long double>(hi) * 18446744073709551616.0L + static_cast<long double>(lo);
+    }
+};
+
+#endif